@@ -1053,6 +1053,66 @@ int bladerf_sync_rx(struct bladerf *dev,
     return status;
 }
 
+int bladerf_sync_rx_acquire(struct bladerf *dev,
+                            struct bladerf_sync_rx_buffer *buffer,
+                            unsigned int timeout_ms)
+{
+    int status;
+
+    MUTEX_LOCK(&dev->sync_lock[BLADERF_MODULE_RX]);
+    status = sync_rx_acquire(dev, buffer, timeout_ms);
+    MUTEX_UNLOCK(&dev->sync_lock[BLADERF_MODULE_RX]);
+
+    return status;
+}
+
+int bladerf_sync_rx_release(struct bladerf *dev,
+                            struct bladerf_sync_rx_buffer *buffer)
+{
+    int status;
+
+    MUTEX_LOCK(&dev->sync_lock[BLADERF_MODULE_RX]);
+    status = sync_rx_release(dev, buffer);
+    MUTEX_UNLOCK(&dev->sync_lock[BLADERF_MODULE_RX]);
+
+    return status;
+}
+
+int bladerf_get_sync_rx_stats(struct bladerf *dev,
+                              struct bladerf_sync_rx_stats *stats)
+{
+    int status;
+
+    MUTEX_LOCK(&dev->sync_lock[BLADERF_MODULE_RX]);
+    status = sync_rx_get_stats(dev, stats);
+    MUTEX_UNLOCK(&dev->sync_lock[BLADERF_MODULE_RX]);
+
+    return status;
+}
+
+int bladerf_set_sync_rx_overrun_wait(struct bladerf *dev, unsigned int wait_us)
+{
+    int status;
+
+    MUTEX_LOCK(&dev->sync_lock[BLADERF_MODULE_RX]);
+    status = sync_rx_set_overrun_wait(dev, wait_us);
+    MUTEX_UNLOCK(&dev->sync_lock[BLADERF_MODULE_RX]);
+
+    return status;
+}
+
+int bladerf_set_sync_rx_wakeups(struct bladerf *dev, unsigned int batch,
+                                unsigned int spin_us)
+{
+    int status;
+
+    MUTEX_LOCK(&dev->sync_lock[BLADERF_MODULE_RX]);
+    status = sync_rx_set_wakeups(dev, batch, spin_us);
+    MUTEX_UNLOCK(&dev->sync_lock[BLADERF_MODULE_RX]);
+
+    return status;
+}
+
 int bladerf_init_stream(struct bladerf_stream **stream,
                         struct bladerf *dev,
                         bladerf_stream_cb callback,
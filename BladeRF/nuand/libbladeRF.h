@@ -1634,6 +1634,10 @@ typedef enum {
 /**
  * A sample overrun has occurred. This indicates that either the host
  * (more likely) or the FPGA is not keeping up with the incoming samples
+ *
+ * bladerf_sync_rx() sets it when it stops at a discontinuity, and when
+ * samples dropped by the host precede the first sample it returns and were
+ * not reported yet.
  */
 #define BLADERF_META_STATUS_OVERRUN  (1 << 0)
 
@@ -2270,6 +2274,201 @@ int CALL_CONV bladerf_sync_rx(struct bladerf *dev,
                               struct bladerf_metadata *metadata,
                               unsigned int timeout_ms);
 
+/**
+ * Received samples lent by bladerf_sync_rx_acquire().
+ *
+ * The samples are left where the stream wrote them. The buffer holds
+ * \p num_messages messages, \p msg_size bytes apart. Each one starts with
+ * \p header_size bytes of metadata, followed by \p samples_per_msg samples.
+ * The samples of message i therefore start at:
+ *
+ * <pre>
+ *  (uint8_t *) data + i * msg_size + header_size
+ * </pre>
+ *
+ * With ::BLADERF_FORMAT_SC16_Q11 there is a single message and no header.
+ */
+struct bladerf_sync_rx_buffer {
+    void *data;                     /**< Start of the first message */
+    unsigned int num_messages;      /**< Number of messages */
+    unsigned int msg_size;          /**< Bytes from a message to the next */
+    unsigned int header_size;       /**< Metadata bytes before the samples */
+    unsigned int samples_per_msg;   /**< Samples in each message */
+    unsigned int num_samples;       /**< Samples in all messages */
+
+    /**
+     * Timestamp of the first sample. Only set with
+     * ::BLADERF_FORMAT_SC16_Q11_META. */
+    uint64_t timestamp;
+
+    /**
+     * Timestamp of the first sample of each message, \p num_messages
+     * entries, or NULL with ::BLADERF_FORMAT_SC16_Q11. Valid until the
+     * buffer is released. */
+    const uint64_t *timestamps;
+
+    /**
+     * ::BLADERF_META_STATUS_OVERRUN when a discontinuity ended the buffer
+     * early, as bladerf_sync_rx() reports in bladerf_metadata::status. */
+    uint32_t status;
+
+    /**
+     * Samples the host dropped right before this buffer because it did not
+     * keep up, 0 if none. See bladerf_get_sync_rx_stats(). */
+    uint64_t samples_lost;
+};
+
+/**
+ * Receive IQ samples without copying them.
+ *
+ * This provides the samples bladerf_sync_rx() would return with
+ * ::BLADERF_META_FLAG_RX_NOW, but instead of copying them into a caller
+ * buffer, it points \p buffer at them inside the synchronous interface's
+ * buffers. The returned samples are contiguous: as with bladerf_sync_rx(),
+ * a discontinuity ends the run early and sets
+ * ::BLADERF_META_STATUS_OVERRUN, while one falling between two calls only
+ * shows in the timestamps.
+ *
+ * The samples belong to the caller until bladerf_sync_rx_release(). Only one
+ * buffer may be acquired at a time, and bladerf_sync_rx() fails with
+ * BLADERF_ERR_INVAL until it is released. The stream keeps filling the other
+ * buffers meanwhile, so holding one for long leads to overruns.
+ *
+ * It may follow bladerf_sync_rx() calls which stopped on a message boundary
+ * (always true without metadata), it fails with BLADERF_ERR_INVAL otherwise.
+ *
+ * @param[in]   dev         Device handle
+ * @param[out]  buffer      Description of the lent samples
+ * @param[in]   timeout_ms  Timeout (milliseconds) for this call to complete.
+ *                          Zero implies "infinite."
+ *
+ * @pre A bladerf_sync_config() call has been to configure the device for
+ *      synchronous data transfer.
+ *
+ * @return 0 on success,
+ *         BLADERF_ERR_UNSUPPORTED if libbladeRF is not built with support
+ *         for this functionality,
+ *         or a value from \ref RETCODES list on failures.
+ */
+API_EXPORT
+int CALL_CONV bladerf_sync_rx_acquire(struct bladerf *dev,
+                                      struct bladerf_sync_rx_buffer *buffer,
+                                      unsigned int timeout_ms);
+
+/**
+ * Give back samples obtained with bladerf_sync_rx_acquire(), so the stream
+ * may reuse their buffer.
+ *
+ * @param[in]   dev         Device handle
+ * @param[in]   buffer      Buffer filled by bladerf_sync_rx_acquire()
+ *
+ * @return 0 on success,
+ *         BLADERF_ERR_INVAL if \p buffer is not currently acquired,
+ *         or a value from \ref RETCODES list on failures.
+ */
+API_EXPORT
+int CALL_CONV bladerf_sync_rx_release(struct bladerf *dev,
+                                      struct bladerf_sync_rx_buffer *buffer);
+
+/**
+ * Host side RX overrun and wakeup counters of the synchronous interface,
+ * cumulative since bladerf_sync_config().
+ *
+ * An overrun happens when a transfer completes while the next sync buffer
+ * is still held by the caller. The transfers in flight are then dropped, so
+ * the buffers stay in order. The samples lost are reported by the next
+ * bladerf_sync_rx() call through ::BLADERF_META_STATUS_OVERRUN, or by
+ * bladerf_sync_rx_buffer::samples_lost.
+ */
+struct bladerf_sync_rx_stats {
+    uint64_t overruns;          /**< Overruns */
+    uint64_t stalls_absorbed;   /**< Overruns avoided by waiting, see
+                                 *   bladerf_set_sync_rx_overrun_wait() */
+    uint64_t buffers_dropped;   /**< Buffers discarded by the overruns */
+
+    /**
+     * Samples lost in the overruns. With ::BLADERF_FORMAT_SC16_Q11_META
+     * this is taken from the timestamps of the buffers around the loss,
+     * otherwise it is buffers_dropped times the buffer size. */
+    uint64_t samples_lost;
+
+    uint64_t sleeps;            /**< Times the caller blocked for a buffer */
+    uint64_t wakeups;           /**< Times the stream woke the caller up */
+    uint64_t spin_hits;         /**< Buffers found by polling, without
+                                 *   sleeping, see
+                                 *   bladerf_set_sync_rx_wakeups() */
+};
+
+/**
+ * Read the RX overrun counters of the synchronous interface.
+ *
+ * @param[in]   dev         Device handle
+ * @param[out]  stats       Counters
+ *
+ * @pre A bladerf_sync_config() call has been to configure the device for
+ *      synchronous data transfer.
+ *
+ * @return 0 on success,
+ *         BLADERF_ERR_INVAL if the RX synchronous interface is not
+ *         configured,
+ *         or a value from \ref RETCODES list on failures.
+ */
+API_EXPORT
+int CALL_CONV bladerf_get_sync_rx_stats(struct bladerf *dev,
+                                        struct bladerf_sync_rx_stats *stats);
+
+/**
+ * Let the RX stream wait up to \p wait_us for the caller to free a sync
+ * buffer before declaring an overrun. A short stall of the caller then only
+ * delays a transfer instead of dropping all the transfers in flight.
+ *
+ * The wait happens in the thread handling the USB transfers, while the other
+ * transfers keep receiving. It should stay well below the time
+ * (num_transfers - 1) buffers take to fill. The default, 0, drops at once.
+ * The setting lasts until the next bladerf_sync_config().
+ *
+ * @param[in]   dev         Device handle
+ * @param[in]   wait_us     Longest wait, in microseconds
+ *
+ * @return 0 on success,
+ *         BLADERF_ERR_INVAL if the RX synchronous interface is not
+ *         configured,
+ *         or a value from \ref RETCODES list on failures.
+ */
+API_EXPORT
+int CALL_CONV bladerf_set_sync_rx_overrun_wait(struct bladerf *dev,
+                                               unsigned int wait_us);
+
+/**
+ * Tune how the RX stream wakes up a caller blocked in bladerf_sync_rx() or
+ * bladerf_sync_rx_acquire().
+ *
+ * The stream only signals a caller that is actually sleeping, and with
+ * \p batch greater than 1 only once that many buffers are ready, so a caller
+ * that sleeps is woken up less often and processes several buffers per
+ * wakeup. Before sleeping, the caller polls for up to \p spin_us. The
+ * polling time shrinks when it keeps expiring and grows back when a buffer
+ * shows up during it. Polling burns CPU but avoids the cost and jitter of a
+ * wakeup when buffers arrive more often than a thread can be rescheduled.
+ *
+ * The defaults are a batch of 1 and no polling. \p batch is limited to the
+ * number of buffers that can be full while transfers are in flight. The
+ * setting lasts until the next bladerf_sync_config().
+ *
+ * @param[in]   dev         Device handle
+ * @param[in]   batch       Ready buffers needed to wake a sleeping caller
+ * @param[in]   spin_us     Longest polling before sleeping, in microseconds
+ *
+ * @return 0 on success,
+ *         BLADERF_ERR_INVAL if the RX synchronous interface is not
+ *         configured,
+ *         or a value from \ref RETCODES list on failures.
+ */
+API_EXPORT
+int CALL_CONV bladerf_set_sync_rx_wakeups(struct bladerf *dev,
+                                          unsigned int batch,
+                                          unsigned int spin_us);
+
 
 /** @} (End of FN_DATA_SYNC) */
 
@@ -168,6 +168,15 @@ int sync_init(struct bladerf *dev,
                 sync->meta.msg_timestamp = 0;
                 sync->meta.msg_flags = 0;
 
+                sync->lent.timestamps = (uint64_t*)
+                    calloc(sync->meta.msg_per_buf, sizeof(uint64_t));
+                sync->buf_mgmt.lost = (uint64_t*)
+                    calloc(num_buffers, sizeof(uint64_t));
+                if (sync->lent.timestamps == NULL ||
+                    sync->buf_mgmt.lost == NULL) {
+                    status = BLADERF_ERR_MEM;
+                }
+
                 break;
 
             case BLADERF_MODULE_TX:
@@ -187,7 +196,9 @@ int sync_init(struct bladerf *dev,
                 return BLADERF_ERR_INVAL;
         }
 
-        status = sync_worker_init(sync);
+        if (status == 0) {
+            status = sync_worker_init(sync);
+        }
     }
 
     if (status != 0) {
@@ -212,6 +223,8 @@ void sync_deinit(struct bladerf_sync *sync)
 
          /* De-allocate our buffer management resources */
         free(sync->buf_mgmt.status);
+        free(sync->buf_mgmt.lost);
+        free(sync->lent.timestamps);
         free(sync);
     }
 }
@@ -259,8 +272,11 @@ static inline void advance_rx_buffer(struct buffer_mgmt *b)
 {
     log_verbose("%s: Marking buf[%u] empty.\n", __FUNCTION__, b->cons_i);
 
-    b->status[b->cons_i] = SYNC_BUFFER_EMPTY;
-    b->cons_i = (b->cons_i + 1) % b->num_buffers;
+    /* Hands the buffer back to rx_callback() once we are done reading it */
+    ATOMIC_STORE_RELEASE(&b->status[b->cons_i], SYNC_BUFFER_EMPTY);
+
+    /* Also read by rx_callback() to size the wakeup batch */
+    ATOMIC_STORE_RELAXED(&b->cons_i, (b->cons_i + 1) % b->num_buffers);
 }
 
 static inline unsigned int timestamp_to_msg(struct bladerf_sync *s, uint64_t t)
@@ -270,6 +286,285 @@ static inline unsigned int timestamp_to_msg(struct bladerf_sync *s, uint64_t t)
     return (unsigned int) m;
 }
 
+#ifndef SYNC_RX_SPIN_CHECKS
+#   define SYNC_RX_SPIN_CHECKS 64   /* Status checks between clock reads */
+#endif
+
+/* The spin budget must not follow wall clock steps. CLOCK_REALTIME is only
+ * needed for the pthread_cond_timedwait() deadline. */
+#ifdef CLOCK_MONOTONIC
+#   define SYNC_RX_SPIN_CLOCK CLOCK_MONOTONIC
+#else
+#   define SYNC_RX_SPIN_CLOCK CLOCK_REALTIME    /* WIN32 clock_gettime() */
+#endif
+
+static inline uint64_t elapsed_us(const struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(SYNC_RX_SPIN_CLOCK, &now);
+    return (uint64_t) (now.tv_sec - start->tv_sec) * 1000000 +
+           (now.tv_nsec - start->tv_nsec) / 1000;
+}
+
+/* Polls buffers[cons_i] for up to spin_us before the consumer goes to sleep.
+ * The budget doubles, up to spin_max_us, when the buffer shows up while
+ * polling and halves when polling expires, so a stream that keeps the
+ * consumer waiting long stops costing it CPU. */
+static bool rx_spin_for_buffer(struct buffer_mgmt *b)
+{
+    const unsigned int max_us = ATOMIC_LOAD_RELAXED(&b->spin_max_us);
+    struct timespec start;
+    unsigned int i;
+
+    if (max_us == 0) {
+        return false;
+    } else if (b->spin_us == 0 || b->spin_us > max_us) {
+        b->spin_us = max_us;
+    }
+
+    clock_gettime(SYNC_RX_SPIN_CLOCK, &start);
+
+    do {
+        for (i = 0; i < SYNC_RX_SPIN_CHECKS; i++) {
+            if (ATOMIC_LOAD_ACQUIRE(&b->status[b->cons_i]) == SYNC_BUFFER_FULL) {
+                b->spin_us = uint_min(b->spin_us * 2, max_us);
+                ATOMIC_STORE_RELAXED(&b->stats.spin_hits,
+                                     b->stats.spin_hits + 1);
+                return true;
+            }
+        }
+    } while (elapsed_us(&start) < b->spin_us);
+
+    b->spin_us = b->spin_us > 1 ? b->spin_us / 2 : 1;
+    return false;
+}
+
+/* Performs one step of getting to the next FULL buffer: checks or (re)starts
+ * the worker, or waits for the buffer. Once the buffer is claimed, s->state is
+ * SYNC_STATE_USING_BUFFER or SYNC_STATE_USING_BUFFER_META. */
+static int rx_next_buffer(struct bladerf_sync *s, unsigned int timeout_ms)
+{
+    struct buffer_mgmt *b = &s->buf_mgmt;
+    int status = 0;
+
+    switch (s->state) {
+        case SYNC_STATE_CHECK_WORKER: {
+            int stream_error;
+            sync_worker_state worker_state =
+                sync_worker_get_state(s->worker, &stream_error);
+
+            /* Propagate stream error back to the caller.
+             * They can call this function again to restart the stream and
+             * try again.
+             */
+            if (stream_error != 0) {
+                status = stream_error;
+            } else {
+                if (worker_state == SYNC_WORKER_STATE_IDLE) {
+                    log_debug("%s: Worker is idle. Going to reset buf "
+                              "mgmt.\n", __FUNCTION__);
+                    s->state = SYNC_STATE_RESET_BUF_MGMT;
+                } else if (worker_state == SYNC_WORKER_STATE_RUNNING) {
+                    s->state = SYNC_STATE_WAIT_FOR_BUFFER;
+                } else {
+                    status = BLADERF_ERR_UNEXPECTED;
+                    log_debug("%s: Unexpected worker state=%d\n",
+                            __FUNCTION__, worker_state);
+                }
+            }
+
+            break;
+        }
+
+        case SYNC_STATE_RESET_BUF_MGMT:
+            MUTEX_LOCK(&b->lock);
+            /* When the RX stream starts up, it will submit the first T
+             * transfers, so the consumer index must be reset to 0 */
+            b->cons_i = 0;
+            b->rx_lost = 0;
+            MUTEX_UNLOCK(&b->lock);
+            log_debug("%s: Reset buf_mgmt consumer index\n", __FUNCTION__);
+            s->state = SYNC_STATE_START_WORKER;
+            break;
+
+
+        case SYNC_STATE_START_WORKER:
+            sync_worker_submit_request(s->worker, SYNC_WORKER_START);
+
+            status = sync_worker_wait_for_state(
+                                            s->worker,
+                                            SYNC_WORKER_STATE_RUNNING,
+                                            SYNC_WORKER_START_TIMEOUT_MS);
+
+            if (status == 0) {
+                s->state = SYNC_STATE_WAIT_FOR_BUFFER;
+                log_debug("%s: Worker is now running.\n", __FUNCTION__);
+            } else {
+                log_debug("%s: Failed to start worker, (%d)\n",
+                          __FUNCTION__, status);
+            }
+            break;
+
+        case SYNC_STATE_WAIT_FOR_BUFFER:
+            /* Check the buffer state, as the worker may have produced one
+             * since we last queried the status */
+            if (ATOMIC_LOAD_ACQUIRE(&b->status[b->cons_i]) == SYNC_BUFFER_FULL) {
+                s->state = SYNC_STATE_BUFFER_READY;
+                log_verbose("%s: buffer %u is ready to consume\n",
+                            __FUNCTION__, b->cons_i);
+                break;
+            }
+
+            if (rx_spin_for_buffer(b)) {
+                s->state = SYNC_STATE_BUFFER_READY;
+                break;
+            }
+
+            /* Sleep. rx_callback() checks rx_waiting after publishing a
+             * buffer, so either we see the buffer here or it signals. */
+            MUTEX_LOCK(&b->lock);
+            ATOMIC_STORE_SEQ(&b->rx_waiting, 1);
+
+            if (ATOMIC_LOAD_SEQ(&b->status[b->cons_i]) != SYNC_BUFFER_FULL) {
+                ATOMIC_STORE_RELAXED(&b->stats.sleeps, b->stats.sleeps + 1);
+                status = wait_for_buffer(b, timeout_ms,
+                                         __FUNCTION__, b->cons_i);
+            }
+
+            ATOMIC_STORE_SEQ(&b->rx_waiting, 0);
+            MUTEX_UNLOCK(&b->lock);
+
+            /* rx_callback() waits for a whole batch before signalling, so a
+             * stream stopping short of it leaves a buffer behind the timeout */
+            if (status == BLADERF_ERR_TIMEOUT &&
+                ATOMIC_LOAD_ACQUIRE(&b->status[b->cons_i]) == SYNC_BUFFER_FULL) {
+                status = 0;
+            }
+
+            if (status == 0) {
+                if (ATOMIC_LOAD_ACQUIRE(&b->status[b->cons_i]) != SYNC_BUFFER_FULL) {
+                    s->state = SYNC_STATE_CHECK_WORKER;
+                } else {
+                    s->state = SYNC_STATE_BUFFER_READY;
+                    log_verbose("%s: buffer %u is ready to consume\n",
+                                __FUNCTION__, b->cons_i);
+                }
+            }
+            break;
+
+        case SYNC_STATE_BUFFER_READY:
+            b->status[b->cons_i] = SYNC_BUFFER_PARTIAL;
+            b->partial_off = 0;
+
+            /* Published by rx_callback() along with the FULL status */
+            b->rx_lost = b->lost[b->cons_i];
+
+            switch (s->stream_config.format) {
+                case BLADERF_FORMAT_SC16_Q11:
+                    s->state = SYNC_STATE_USING_BUFFER;
+                    break;
+
+                case BLADERF_FORMAT_SC16_Q11_META:
+                    s->state = SYNC_STATE_USING_BUFFER_META;
+                    s->meta.curr_msg_off = 0;
+                    s->meta.msg_num = 0;
+                    break;
+
+                default:
+                    assert(!"Invalid stream format");
+                    status = BLADERF_ERR_UNEXPECTED;
+            }
+            break;
+
+        default:
+            assert(!"Invalid state");
+            status = BLADERF_ERR_UNEXPECTED;
+    }
+
+    return status;
+}
+
+/* Fast path of SYNC_STATE_USING_BUFFER_META, at a message boundary. Checks the
+ * headers of all the messages of the current buffer that the request spans in
+ * one pass and gathers the payloads of the leading contiguous ones, leaving
+ * the meta state as the per-message path would. When *t_first is not
+ * UINT64_MAX, the first message must start there.
+ *
+ * Returns the number of samples copied and sets *t_first to the timestamp of
+ * the first one. Returns 0 when the first message needs a seek, so the
+ * per-message path handles seeks and discontinuities. */
+static unsigned int rx_gather_msgs(struct bladerf_sync *s, uint8_t *dest,
+                                   unsigned int num_samples, uint64_t *t_first)
+{
+    struct buffer_mgmt *b = &s->buf_mgmt;
+    const size_t msg_size = s->dev->msg_size;
+    const unsigned int spm = s->meta.samples_per_msg;
+    uint8_t *first_msg = (uint8_t*)b->buffers[b->cons_i] +
+                         msg_size * s->meta.msg_num;
+    unsigned int n_msg, i;
+    unsigned int copied = 0;
+    unsigned int last_copy = 0;
+    uint64_t t;
+
+    n_msg = uint_min(s->meta.msg_per_buf - s->meta.msg_num,
+                     (num_samples + spm - 1) / spm);
+    assert(n_msg > 0);
+
+    t = metadata_get_timestamp(first_msg);
+    if (*t_first != UINT64_MAX && t != *t_first) {
+        return 0;
+    }
+    *t_first = t;
+
+    /* A discontinuity stops the gather before its message, whose header the
+     * per-message path then reads and reports */
+    for (i = 1; i < n_msg; i++) {
+        t += spm;
+        if (metadata_get_timestamp(first_msg + msg_size * i) != t) {
+            n_msg = i;
+            break;
+        }
+    }
+
+    for (i = 0; i < n_msg; i++) {
+        last_copy = uint_min(num_samples - copied, spm);
+        memcpy(dest + samples2bytes(s, copied),
+               first_msg + msg_size * i + METADATA_HEADER_SIZE,
+               samples2bytes(s, last_copy));
+        copied += last_copy;
+    }
+
+    s->meta.curr_timestamp = *t_first + copied;
+
+    if (last_copy < spm) {
+        /* The request ends within the last message */
+        s->meta.msg_num += n_msg - 1;
+        s->meta.curr_msg = first_msg + msg_size * (n_msg - 1);
+        s->meta.msg_timestamp = metadata_get_timestamp(s->meta.curr_msg);
+        s->meta.msg_flags = metadata_get_flags(s->meta.curr_msg);
+        s->meta.curr_msg_off = last_copy;
+        s->meta.state = SYNC_META_STATE_SAMPLES;
+    } else {
+        s->meta.msg_num += n_msg;
+        s->meta.curr_msg_off = 0;
+        s->meta.state = SYNC_META_STATE_HEADER;
+
+        if (s->meta.msg_num >= s->meta.msg_per_buf) {
+            assert(s->meta.msg_num == s->meta.msg_per_buf);
+            advance_rx_buffer(b);
+            s->meta.msg_num = 0;
+            s->state = SYNC_STATE_WAIT_FOR_BUFFER;
+        }
+    }
+
+    log_verbose("%s: Gathered %u samples from %u messages, t=%llu\n",
+                __FUNCTION__, copied, n_msg,
+                (unsigned long long)s->meta.curr_timestamp);
+
+    return copied;
+}
+
 int sync_rx(struct bladerf *dev, void *samples, unsigned num_samples,
             struct bladerf_metadata *user_meta, unsigned int timeout_ms)
 {
@@ -297,6 +592,8 @@ int sync_rx(struct bladerf *dev, void *samples, unsigned num_samples,
             user_meta->status = 0;
             target_timestamp = user_meta->timestamp;
         }
+    } else if (user_meta != NULL) {
+        user_meta->status = 0;
     }
 
     b = &s->buf_mgmt;
@@ -307,116 +604,30 @@ int sync_rx(struct bladerf *dev, void *samples, unsigned num_samples,
     while (!exit_early && samples_returned < num_samples && status == 0) {
 
         switch (s->state) {
-            case SYNC_STATE_CHECK_WORKER: {
-                int stream_error;
-                sync_worker_state worker_state =
-                    sync_worker_get_state(s->worker, &stream_error);
-
-                /* Propagate stream error back to the caller.
-                 * They can call this function again to restart the stream and
-                 * try again.
-                 */
-                if (stream_error != 0) {
-                    status = stream_error;
-                } else {
-                    if (worker_state == SYNC_WORKER_STATE_IDLE) {
-                        log_debug("%s: Worker is idle. Going to reset buf "
-                                  "mgmt.\n", __FUNCTION__);
-                        s->state = SYNC_STATE_RESET_BUF_MGMT;
-                    } else if (worker_state == SYNC_WORKER_STATE_RUNNING) {
-                        s->state = SYNC_STATE_WAIT_FOR_BUFFER;
-                    } else {
-                        status = BLADERF_ERR_UNEXPECTED;
-                        log_debug("%s: Unexpected worker state=%d\n",
-                                __FUNCTION__, worker_state);
-                    }
-                }
-
-                break;
-            }
-
+            case SYNC_STATE_CHECK_WORKER:
             case SYNC_STATE_RESET_BUF_MGMT:
-                MUTEX_LOCK(&b->lock);
-                /* When the RX stream starts up, it will submit the first T
-                 * transfers, so the consumer index must be reset to 0 */
-                b->cons_i = 0;
-                MUTEX_UNLOCK(&b->lock);
-                log_debug("%s: Reset buf_mgmt consumer index\n", __FUNCTION__);
-                s->state = SYNC_STATE_START_WORKER;
-                break;
-
-
             case SYNC_STATE_START_WORKER:
-                sync_worker_submit_request(s->worker, SYNC_WORKER_START);
-
-                status = sync_worker_wait_for_state(
-                                                s->worker,
-                                                SYNC_WORKER_STATE_RUNNING,
-                                                SYNC_WORKER_START_TIMEOUT_MS);
-
-                if (status == 0) {
-                    s->state = SYNC_STATE_WAIT_FOR_BUFFER;
-                    log_debug("%s: Worker is now running.\n", __FUNCTION__);
-                } else {
-                    log_debug("%s: Failed to start worker, (%d)\n",
-                              __FUNCTION__, status);
-                }
-                break;
-
             case SYNC_STATE_WAIT_FOR_BUFFER:
-                MUTEX_LOCK(&b->lock);
-
-                /* Check the buffer state, as the worker may have produced one
-                 * since we last queried the status */
-                if (b->status[b->cons_i] == SYNC_BUFFER_FULL) {
-                    s->state = SYNC_STATE_BUFFER_READY;
-                    log_verbose("%s: buffer %u is ready to consume\n",
-                                __FUNCTION__, b->cons_i);
-                } else {
-                    status = wait_for_buffer(b, timeout_ms,
-                                             __FUNCTION__, b->cons_i);
-
-                    if (status == 0) {
-                        if (b->status[b->cons_i] != SYNC_BUFFER_FULL) {
-                            s->state = SYNC_STATE_CHECK_WORKER;
-                        } else {
-                            s->state = SYNC_STATE_BUFFER_READY;
-                            log_verbose("%s: buffer %u is ready to consume\n",
-                                        __FUNCTION__, b->cons_i);
-                        }
-                    }
-                }
-
-                MUTEX_UNLOCK(&b->lock);
-                break;
-
             case SYNC_STATE_BUFFER_READY:
-                MUTEX_LOCK(&b->lock);
-                b->status[b->cons_i] = SYNC_BUFFER_PARTIAL;
-                b->partial_off = 0;
-
-                switch (s->stream_config.format) {
-                    case BLADERF_FORMAT_SC16_Q11:
-                        s->state = SYNC_STATE_USING_BUFFER;
-                        break;
-
-                    case BLADERF_FORMAT_SC16_Q11_META:
-                        s->state = SYNC_STATE_USING_BUFFER_META;
-                        s->meta.curr_msg_off = 0;
-                        s->meta.msg_num = 0;
-                        break;
-
-                    default:
-                        assert(!"Invalid stream format");
-                        status = BLADERF_ERR_UNEXPECTED;
+                status = rx_next_buffer(s, timeout_ms);
+
+                /* Samples dropped by rx_callback() before the buffer just
+                 * claimed end the run, or are reported up front if there is
+                 * none yet */
+                if (status == 0 && b->rx_lost != 0 && user_meta != NULL) {
+                    user_meta->status |= BLADERF_META_STATUS_OVERRUN;
+                    exit_early = copied_data;
+                    b->rx_lost = 0;
                 }
+                break;
 
-                MUTEX_UNLOCK(&b->lock);
+            case SYNC_STATE_BUFFER_ACQUIRED:
+                log_debug("%s: Buffer still acquired, release it first\n",
+                          __FUNCTION__);
+                status = BLADERF_ERR_INVAL;
                 break;
 
             case SYNC_STATE_USING_BUFFER: /* SC16Q11 buffers w/o metadata */
-                MUTEX_LOCK(&b->lock);
-
                 buf_src = (uint8_t*)b->buffers[b->cons_i];
 
                 samples_to_copy = uint_min(num_samples - samples_returned,
@@ -442,13 +653,39 @@ int sync_rx(struct bladerf *dev, void *samples, unsigned num_samples,
                     advance_rx_buffer(b);
                     s->state = SYNC_STATE_WAIT_FOR_BUFFER;
                 }
-
-                MUTEX_UNLOCK(&b->lock);
                 break;
 
 
             case SYNC_STATE_USING_BUFFER_META: /* SC16Q11 buffers w/ metadata */
-                MUTEX_LOCK(&b->lock);
+                if (s->meta.state == SYNC_META_STATE_HEADER) {
+                    uint64_t t_first = UINT64_MAX;
+
+                    if (copied_data) {
+                        t_first = s->meta.curr_timestamp;
+                    } else if ((user_meta->flags & BLADERF_META_FLAG_RX_NOW) == 0) {
+                        t_first = target_timestamp;
+                    }
+
+                    samples_to_copy =
+                        rx_gather_msgs(s, samples_dest +
+                                          samples2bytes(s, samples_returned),
+                                       num_samples - samples_returned,
+                                       &t_first);
+
+                    if (samples_to_copy > 0) {
+                        if (!copied_data &&
+                            (user_meta->flags & BLADERF_META_FLAG_RX_NOW)) {
+                            /* Timestamp of the first returned sample, as
+                             * below */
+                            user_meta->timestamp = t_first;
+                        }
+
+                        samples_returned += samples_to_copy;
+                        copied_data = true;
+                        target_timestamp = s->meta.curr_timestamp;
+                        break;
+                    }
+                }
 
                 switch (s->meta.state) {
                     case SYNC_META_STATE_HEADER:
@@ -604,8 +841,6 @@ int sync_rx(struct bladerf *dev, void *samples, unsigned num_samples,
                         assert(!"Invalid state");
                         status = BLADERF_ERR_UNEXPECTED;
                 }
-
-                MUTEX_UNLOCK(&b->lock);
                 break;
         }
     }
@@ -617,6 +852,200 @@ int sync_rx(struct bladerf *dev, void *samples, unsigned num_samples,
     return status;
 }
 
+int sync_rx_acquire(struct bladerf *dev, struct bladerf_sync_rx_buffer *buffer,
+                    unsigned int timeout_ms)
+{
+    struct bladerf_sync *s = dev->sync[BLADERF_MODULE_RX];
+    struct buffer_mgmt *b;
+    uint8_t *buf_src;
+    unsigned int n;
+    int status = 0;
+
+    if (s == NULL || buffer == NULL) {
+        log_debug("NULL pointer passed to %s\n", __FUNCTION__);
+        return BLADERF_ERR_INVAL;
+    } else if (s->state == SYNC_STATE_BUFFER_ACQUIRED) {
+        log_debug("%s: Buffer still acquired, release it first\n",
+                  __FUNCTION__);
+        return BLADERF_ERR_INVAL;
+    } else if (s->state == SYNC_STATE_USING_BUFFER_META &&
+               s->meta.state == SYNC_META_STATE_SAMPLES) {
+        log_debug("%s: sync_rx() stopped within a message\n", __FUNCTION__);
+        return BLADERF_ERR_INVAL;
+    }
+
+    b = &s->buf_mgmt;
+
+    while (status == 0 && s->state != SYNC_STATE_USING_BUFFER &&
+                          s->state != SYNC_STATE_USING_BUFFER_META) {
+        status = rx_next_buffer(s, timeout_ms);
+    }
+
+    if (status != 0) {
+        return status;
+    }
+
+    buf_src = (uint8_t*)b->buffers[b->cons_i];
+    memset(buffer, 0, sizeof(*buffer));
+
+    buffer->samples_lost = b->rx_lost;
+    b->rx_lost = 0;
+
+    if (s->state == SYNC_STATE_USING_BUFFER) {
+        /* Whatever sync_rx() left of the buffer */
+        n = s->stream_config.samples_per_buffer - b->partial_off;
+
+        buffer->data = buf_src + samples2bytes(s, b->partial_off);
+        buffer->num_messages = 1;
+        buffer->msg_size = (unsigned int) samples2bytes(s, n);
+        buffer->samples_per_msg = n;
+        buffer->num_samples = n;
+    } else {
+        uint64_t expected = 0;
+
+        /* Lend the messages up to the end of the buffer or to the first
+         * discontinuity, like a sync_rx() call would return them */
+        for (n = 0; s->meta.msg_num + n < s->meta.msg_per_buf; n++) {
+            const uint8_t *msg = buf_src + dev->msg_size * (s->meta.msg_num + n);
+            const uint64_t t = metadata_get_timestamp(msg);
+
+            if (n > 0 && t != expected) {
+                buffer->status |= BLADERF_META_STATUS_OVERRUN;
+                log_debug("Sample discontinuity detected @ "
+                          "buffer %u, message %u: Expected t=%llu, "
+                          "got t=%llu\n",
+                          b->cons_i, s->meta.msg_num + n,
+                          (unsigned long long)expected,
+                          (unsigned long long)t);
+                break;
+            }
+
+            s->lent.timestamps[n] = t;
+            expected = t + s->meta.samples_per_msg;
+        }
+
+        buffer->data = buf_src + dev->msg_size * s->meta.msg_num;
+        buffer->num_messages = n;
+        buffer->msg_size = (unsigned int) dev->msg_size;
+        buffer->header_size = METADATA_HEADER_SIZE;
+        buffer->samples_per_msg = s->meta.samples_per_msg;
+        buffer->num_samples = n * s->meta.samples_per_msg;
+        buffer->timestamp = s->lent.timestamps[0];
+        buffer->timestamps = s->lent.timestamps;
+
+        s->meta.curr_timestamp = expected;
+    }
+
+    s->lent.data = buffer->data;
+    s->lent.count = buffer->num_messages;
+    s->state = SYNC_STATE_BUFFER_ACQUIRED;
+
+    log_verbose("%s: Lent %u samples of buffer %u\n",
+                __FUNCTION__, buffer->num_samples, b->cons_i);
+
+    return 0;
+}
+
+int sync_rx_release(struct bladerf *dev, struct bladerf_sync_rx_buffer *buffer)
+{
+    struct bladerf_sync *s = dev->sync[BLADERF_MODULE_RX];
+    struct buffer_mgmt *b;
+
+    if (s == NULL || buffer == NULL) {
+        log_debug("NULL pointer passed to %s\n", __FUNCTION__);
+        return BLADERF_ERR_INVAL;
+    } else if (s->state != SYNC_STATE_BUFFER_ACQUIRED ||
+               buffer->data != s->lent.data) {
+        log_debug("%s: Buffer is not acquired\n", __FUNCTION__);
+        return BLADERF_ERR_INVAL;
+    }
+
+    b = &s->buf_mgmt;
+
+    if (s->stream_config.format == BLADERF_FORMAT_SC16_Q11_META) {
+        s->meta.msg_num += s->lent.count;
+        s->meta.state = SYNC_META_STATE_HEADER;
+
+        if (s->meta.msg_num < s->meta.msg_per_buf) {
+            /* Stopped at a discontinuity, the rest is for the next call */
+            s->state = SYNC_STATE_USING_BUFFER_META;
+        } else {
+            assert(s->meta.msg_num == s->meta.msg_per_buf);
+            advance_rx_buffer(b);
+            s->meta.msg_num = 0;
+            s->state = SYNC_STATE_WAIT_FOR_BUFFER;
+        }
+    } else {
+        advance_rx_buffer(b);
+        s->state = SYNC_STATE_WAIT_FOR_BUFFER;
+    }
+
+    s->lent.data = NULL;
+    s->lent.count = 0;
+    buffer->data = NULL;
+
+    return 0;
+}
+
+int sync_rx_get_stats(struct bladerf *dev, struct bladerf_sync_rx_stats *stats)
+{
+    struct bladerf_sync *s = dev->sync[BLADERF_MODULE_RX];
+
+    if (s == NULL || stats == NULL) {
+        log_debug("NULL pointer passed to %s\n", __FUNCTION__);
+        return BLADERF_ERR_INVAL;
+    }
+
+    stats->overruns = ATOMIC_LOAD_RELAXED(&s->buf_mgmt.stats.overruns);
+    stats->stalls_absorbed =
+        ATOMIC_LOAD_RELAXED(&s->buf_mgmt.stats.stalls_absorbed);
+    stats->buffers_dropped =
+        ATOMIC_LOAD_RELAXED(&s->buf_mgmt.stats.buffers_dropped);
+    stats->samples_lost = ATOMIC_LOAD_RELAXED(&s->buf_mgmt.stats.samples_lost);
+    stats->sleeps = ATOMIC_LOAD_RELAXED(&s->buf_mgmt.stats.sleeps);
+    stats->wakeups = ATOMIC_LOAD_RELAXED(&s->buf_mgmt.stats.wakeups);
+    stats->spin_hits = ATOMIC_LOAD_RELAXED(&s->buf_mgmt.stats.spin_hits);
+
+    return 0;
+}
+
+int sync_rx_set_overrun_wait(struct bladerf *dev, unsigned int wait_us)
+{
+    struct bladerf_sync *s = dev->sync[BLADERF_MODULE_RX];
+
+    if (s == NULL) {
+        log_debug("RX sync interface not configured\n");
+        return BLADERF_ERR_INVAL;
+    }
+
+    ATOMIC_STORE_RELAXED(&s->buf_mgmt.overrun_wait_us, wait_us);
+    return 0;
+}
+
+int sync_rx_set_wakeups(struct bladerf *dev, unsigned int batch,
+                        unsigned int spin_us)
+{
+    struct bladerf_sync *s = dev->sync[BLADERF_MODULE_RX];
+    unsigned int max_batch;
+
+    if (s == NULL) {
+        log_debug("RX sync interface not configured\n");
+        return BLADERF_ERR_INVAL;
+    }
+
+    /* More buffers than this are never FULL at once without an overrun */
+    max_batch = s->buf_mgmt.num_buffers - s->stream_config.num_xfers;
+    if (batch > max_batch) {
+        log_debug("%s: Clamping wakeup batch of %u to %u\n",
+                  __FUNCTION__, batch, max_batch);
+        batch = max_batch;
+    }
+
+    ATOMIC_STORE_RELAXED(&s->buf_mgmt.wake_batch, batch);
+    ATOMIC_STORE_RELAXED(&s->buf_mgmt.spin_max_us, spin_us);
+    return 0;
+}
+
 /* Assumes buffer lock is held */
 static int advance_tx_buffer(struct bladerf_sync *s, struct buffer_mgmt *b)
 {
@@ -828,6 +1257,7 @@ int sync_tx(struct bladerf *dev, void *samples, unsigned int num_samples,
             }
 
             case SYNC_STATE_RESET_BUF_MGMT:
+            case SYNC_STATE_BUFFER_ACQUIRED: /* RX only */
                 assert(!"Bug");
                 break;
 
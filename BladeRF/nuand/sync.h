@@ -65,6 +65,12 @@ typedef enum {
 
 #define BUFFER_MGMT_INVALID_INDEX (UINT_MAX)
 
+/* For RX, status[] forms a single-producer/single-consumer ring: rx_callback()
+ * owns prod_i and turns IN_FLIGHT buffers FULL, sync_rx() owns cons_i and
+ * partial_off and turns FULL buffers EMPTY. Both sides access status[] with
+ * acquire/release atomics, without the lock. The lock and buf_ready are only
+ * used when sync_rx() has to sleep (rx_waiting set), for worker start/stop,
+ * and for TX, which still does all of its buffer management under the lock. */
 struct buffer_mgmt {
     sync_buffer_status *status;
 
@@ -88,6 +94,30 @@ struct buffer_mgmt {
     MUTEX lock;
     pthread_cond_t  buf_ready;  /**< Buffer produced by RX callback, or
                                  *   buffer emptied by TX callback */
+
+    int rx_waiting;             /**< RX consumer is about to wait on buf_ready */
+
+    /* RX overrun accounting. rx_callback() stores the samples lost right
+     * before a buffer in lost[] ahead of publishing it FULL, the consumer
+     * moves it to rx_lost when it claims the buffer and reports it once. */
+    uint64_t *lost;
+    uint64_t rx_lost;           /**< Consumer: lost before buffers[cons_i] */
+    unsigned int lost_bufs;     /**< Producer: dropped since the last FULL */
+    bool next_ts_valid;         /**< Producer: next_ts is known */
+    uint64_t next_ts;           /**< Producer: timestamp expected after the
+                                 *   last FULL buffer (META only) */
+    unsigned int overrun_wait_us; /**< Time rx_callback() gives the consumer
+                                   *   to free a buffer before dropping */
+
+    /* RX wakeups. A sleeping consumer is signalled once wake_batch buffers
+     * are FULL. Before sleeping it polls for up to spin_us, adapted between
+     * 1 and spin_max_us from how often polling pays off. */
+    unsigned int wake_batch;
+    unsigned int spin_max_us;
+    unsigned int spin_us;       /**< Consumer: current polling budget */
+
+    /* Each counter is written by either rx_callback() or the consumer */
+    struct bladerf_sync_rx_stats stats;
 };
 
 /* State of API-side sync interface */
@@ -98,7 +128,8 @@ typedef enum {
     SYNC_STATE_WAIT_FOR_BUFFER,
     SYNC_STATE_BUFFER_READY,
     SYNC_STATE_USING_BUFFER,
-    SYNC_STATE_USING_BUFFER_META
+    SYNC_STATE_USING_BUFFER_META,
+    SYNC_STATE_BUFFER_ACQUIRED      /**< Lent to the caller by sync_rx_acquire() */
 } sync_state;
 
 struct sync_meta
@@ -138,6 +169,13 @@ struct bladerf_sync {
     struct stream_config stream_config;
     struct sync_worker *worker;
     struct sync_meta meta;
+
+    /* Region of buffers[cons_i] lent by sync_rx_acquire() (RX only) */
+    struct {
+        void *data;             /* Start of the region, NULL if none */
+        unsigned int count;     /* Messages (META) or samples lent */
+        uint64_t *timestamps;   /* Per message timestamps, msg_per_buf entries */
+    } lent;
 };
 
 /**
@@ -172,6 +210,46 @@ int sync_rx(struct bladerf *dev, void *samples, unsigned int num_samples,
 int sync_tx(struct bladerf *dev, void *samples, unsigned int num_samples,
              struct bladerf_metadata *metadata, unsigned int timeout_ms);
 
+/**
+ * Lend the caller the next contiguous run of received samples, in place in
+ * the sync buffers. See bladerf_sync_rx_acquire().
+ *
+ * @return 0 or BLADERF_ERR_* value on failure
+ */
+int sync_rx_acquire(struct bladerf *dev, struct bladerf_sync_rx_buffer *buffer,
+                    unsigned int timeout_ms);
+
+/**
+ * Give back the region lent by sync_rx_acquire()
+ *
+ * @return 0 or BLADERF_ERR_INVAL if buffer is not the lent region
+ */
+int sync_rx_release(struct bladerf *dev, struct bladerf_sync_rx_buffer *buffer);
+
+/**
+ * Read the RX overrun counters. See bladerf_get_sync_rx_stats().
+ *
+ * @return 0 or BLADERF_ERR_INVAL if the RX sync interface is not configured
+ */
+int sync_rx_get_stats(struct bladerf *dev, struct bladerf_sync_rx_stats *stats);
+
+/**
+ * Set how long rx_callback() waits for a stalled consumer.
+ * See bladerf_set_sync_rx_overrun_wait().
+ *
+ * @return 0 or BLADERF_ERR_INVAL if the RX sync interface is not configured
+ */
+int sync_rx_set_overrun_wait(struct bladerf *dev, unsigned int wait_us);
+
+/**
+ * Set when rx_callback() wakes a sleeping consumer and how long the consumer
+ * polls before sleeping. See bladerf_set_sync_rx_wakeups().
+ *
+ * @return 0 or BLADERF_ERR_INVAL if the RX sync interface is not configured
+ */
+int sync_rx_set_wakeups(struct bladerf *dev, unsigned int batch,
+                        unsigned int spin_us);
+
 unsigned int sync_buf2idx(struct buffer_mgmt *b, void *addr);
 
 void * sync_idx2buf(struct buffer_mgmt *b, unsigned int idx);
@@ -35,9 +35,89 @@
 #include "sync.h"
 #include "sync_worker.h"
 #include "conversions.h"
+#include "metadata.h"
 
 void *sync_worker_task(void *arg);
 
+#ifndef SYNC_RX_OVERRUN_POLL_US
+#   define SYNC_RX_OVERRUN_POLL_US 50
+#endif
+
+/* Gives a stalled consumer up to wait_us to free buffers[prod_i] */
+static sync_buffer_status rx_wait_for_consumer(struct buffer_mgmt *b,
+                                               unsigned int wait_us)
+{
+    sync_buffer_status status = ATOMIC_LOAD_ACQUIRE(&b->status[b->prod_i]);
+    unsigned int waited = 0;
+
+    while (status != SYNC_BUFFER_EMPTY && waited < wait_us) {
+        usleep(SYNC_RX_OVERRUN_POLL_US);
+        waited += SYNC_RX_OVERRUN_POLL_US;
+        status = ATOMIC_LOAD_ACQUIRE(&b->status[b->prod_i]);
+    }
+
+    return status;
+}
+
+/* Whether to wake a sleeping consumer now that buffers[idx] is FULL: when
+ * enough buffers are ready from its position for the batch */
+static bool rx_batch_ready(struct buffer_mgmt *b, unsigned int idx)
+{
+    const unsigned int batch = ATOMIC_LOAD_RELAXED(&b->wake_batch);
+    const unsigned int cons_i = ATOMIC_LOAD_RELAXED(&b->cons_i);
+
+    if (batch <= 1) {
+        return true;
+    }
+
+    return (idx + b->num_buffers - cons_i) % b->num_buffers + 1 >= batch;
+}
+
+/* Records in lost[idx] the samples dropped since the previous FULL buffer.
+ * With metadata, the exact count comes from the timestamps on both sides of
+ * the loss. Must be called before buffers[idx] is published FULL. */
+static void rx_record_loss(struct bladerf_sync *s, unsigned int idx,
+                           const uint8_t *samples)
+{
+    struct buffer_mgmt *b = &s->buf_mgmt;
+    const size_t msg_size = s->dev->msg_size;
+    uint64_t lost = 0;
+
+    if (s->stream_config.format == BLADERF_FORMAT_SC16_Q11_META) {
+        const uint64_t buf_samples =
+            (uint64_t) s->meta.msg_per_buf * s->meta.samples_per_msg;
+        const uint64_t t = metadata_get_timestamp(samples);
+
+        if (b->lost_bufs > 0) {
+            if (b->next_ts_valid && t > b->next_ts) {
+                lost = t - b->next_ts;
+            } else {
+                lost = b->lost_bufs * buf_samples;
+            }
+        }
+
+        b->next_ts = metadata_get_timestamp(samples + msg_size *
+                                            (s->meta.msg_per_buf - 1)) +
+                     s->meta.samples_per_msg;
+        b->next_ts_valid = true;
+    } else {
+        lost = (uint64_t) b->lost_bufs * s->stream_config.samples_per_buffer;
+    }
+
+    b->lost[idx] = lost;
+
+    if (b->lost_bufs > 0) {
+        ATOMIC_STORE_RELAXED(&b->stats.buffers_dropped,
+                             b->stats.buffers_dropped + b->lost_bufs);
+        ATOMIC_STORE_RELAXED(&b->stats.samples_lost,
+                             b->stats.samples_lost + lost);
+        b->lost_bufs = 0;
+
+        log_debug("RX overrun: %llu samples lost before buffer %u\n",
+                  (unsigned long long) lost, idx);
+    }
+}
+
 static void *rx_callback(struct bladerf *dev,
                          struct bladerf_stream *stream,
                          struct bladerf_metadata *meta,
@@ -67,23 +147,44 @@ static void *rx_callback(struct bladerf *dev,
         return NULL;
     }
 
-    MUTEX_LOCK(&b->lock);
-
     /* Get the index of the buffer that was just filled */
     samples_idx = sync_buf2idx(b, samples);
 
+    /* No lock here: see struct buffer_mgmt */
     if (b->resubmit_count == 0) {
-        if (b->status[b->prod_i] == SYNC_BUFFER_EMPTY) {
+        sync_buffer_status next_status =
+            ATOMIC_LOAD_ACQUIRE(&b->status[b->prod_i]);
+        const unsigned int wait_us = ATOMIC_LOAD_RELAXED(&b->overrun_wait_us);
+
+        if (next_status != SYNC_BUFFER_EMPTY && wait_us > 0) {
+            next_status = rx_wait_for_consumer(b, wait_us);
+            if (next_status == SYNC_BUFFER_EMPTY) {
+                ATOMIC_STORE_RELAXED(&b->stats.stalls_absorbed,
+                                     b->stats.stalls_absorbed + 1);
+            }
+        }
 
-            /* This buffer is now ready for the consumer */
-            b->status[samples_idx] = SYNC_BUFFER_FULL;
-            pthread_cond_signal(&b->buf_ready);
+        if (next_status == SYNC_BUFFER_EMPTY) {
 
             /* Update the state of the buffer being submitted next */
             next_idx = b->prod_i;
-            b->status[next_idx] = SYNC_BUFFER_IN_FLIGHT;
+            ATOMIC_STORE_RELEASE(&b->status[next_idx], SYNC_BUFFER_IN_FLIGHT);
             next_buf = b->buffers[next_idx];
 
+            rx_record_loss(s, samples_idx, (const uint8_t*)samples);
+
+            /* This buffer is now ready for the consumer. Only take the lock
+             * to wake it up if it is going to sleep, and once the batch is
+             * ready. */
+            ATOMIC_STORE_SEQ(&b->status[samples_idx], SYNC_BUFFER_FULL);
+            if (ATOMIC_LOAD_SEQ(&b->rx_waiting) &&
+                rx_batch_ready(b, samples_idx)) {
+                MUTEX_LOCK(&b->lock);
+                pthread_cond_signal(&b->buf_ready);
+                MUTEX_UNLOCK(&b->lock);
+                ATOMIC_STORE_RELAXED(&b->stats.wakeups, b->stats.wakeups + 1);
+            }
+
             /* Advance to the next buffer for the next callback */
             b->prod_i = (next_idx + 1) % b->num_buffers;
 
@@ -91,8 +192,12 @@ static void *rx_callback(struct bladerf *dev,
                         MODULE_STR(s), samples_idx, next_idx);
 
         } else {
-            /* TODO propagate back the RX Overrun to the sync_rx() caller */
+            /* Drop this buffer and the ones in flight after it, so the next
+             * completion is buffers[samples_idx] again and the ring stays in
+             * order. The loss goes with the next FULL buffer. */
             log_debug("RX overrun @ buffer %u\r\n", samples_idx);
+            ATOMIC_STORE_RELAXED(&b->stats.overruns, b->stats.overruns + 1);
+            b->lost_bufs++;
             next_buf = samples;
             b->resubmit_count = s->stream_config.num_xfers - 1;
         }
@@ -100,13 +205,12 @@ static void *rx_callback(struct bladerf *dev,
         /* We're still recovering from an overrun at this point. Just
          * turn around and resubmit this buffer */
         next_buf = samples;
+        b->lost_bufs++;
         b->resubmit_count--;
         log_verbose("Resubmitting buffer %u (%u resubmissions left)\r\n",
                     samples_idx, b->resubmit_count);
     }
 
-
-    MUTEX_UNLOCK(&b->lock);
     return next_buf;
 }
 
@@ -418,6 +522,13 @@ static sync_worker_state exec_idle_state(struct bladerf_sync *s)
             assert(s->stream_config.module == BLADERF_MODULE_RX);
             s->buf_mgmt.prod_i = s->stream_config.num_xfers;
 
+            /* A restarted stream does not follow the previous one */
+            s->buf_mgmt.resubmit_count = 0;
+            s->buf_mgmt.lost_bufs = 0;
+            s->buf_mgmt.next_ts_valid = false;
+            memset(s->buf_mgmt.lost, 0,
+                   s->buf_mgmt.num_buffers * sizeof(uint64_t));
+
             for (i = 0; i < s->buf_mgmt.num_buffers; i++) {
                 if (i < s->stream_config.num_xfers) {
                     s->buf_mgmt.status[i] = SYNC_BUFFER_IN_FLIGHT;
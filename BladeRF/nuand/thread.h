@@ -66,4 +66,17 @@
 #   define MUTEX_UNLOCK(m) pthread_mutex_unlock(m)
 #endif
 
+/* Lock-free accesses to state handed over between two threads. An acquire load
+ * sees everything written before the release store of the value it reads. The
+ * SEQ variants are totally ordered, for "store mine, then check theirs" handshakes
+ * such as deciding whether a sleeping thread must be woken up. */
+#define ATOMIC_LOAD_ACQUIRE(p)      __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define ATOMIC_STORE_RELEASE(p, v)  __atomic_store_n(p, v, __ATOMIC_RELEASE)
+#define ATOMIC_LOAD_SEQ(p)          __atomic_load_n(p, __ATOMIC_SEQ_CST)
+#define ATOMIC_STORE_SEQ(p, v)      __atomic_store_n(p, v, __ATOMIC_SEQ_CST)
+
+/* Counters with a single writer, read from other threads without ordering */
+#define ATOMIC_LOAD_RELAXED(p)      __atomic_load_n(p, __ATOMIC_RELAXED)
+#define ATOMIC_STORE_RELAXED(p, v)  __atomic_store_n(p, v, __ATOMIC_RELAXED)
+
 #endif
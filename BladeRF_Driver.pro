@@ -48,6 +48,18 @@ unix {
 
 SOURCES += \
     entrypoint.cpp \
+    sample_pool.cpp \
+    dsp_kernels.cpp \
+    stream_ring.cpp \
+    thread_placement.cpp \
+    device_config.cpp \
+    resampler.cpp \
+    channelizer.cpp \
+    dc_cal_cache.cpp \
+    rx_stats.cpp \
+    control_queue.cpp \
+    tune_cache.cpp \
+    sweep.cpp \
     jansson/dump.c \
     jansson/error.c \
     jansson/hashtable.c \
@@ -97,6 +109,18 @@ SOURCES += \
 HEADERS +=\
     external_hardware_def.h \
     entrypoint.h \
+    sample_pool.h \
+    dsp_kernels.h \
+    stream_ring.h \
+    thread_placement.h \
+    device_config.h \
+    resampler.h \
+    channelizer.h \
+    dc_cal_cache.h \
+    rx_stats.h \
+    control_queue.h \
+    tune_cache.h \
+    sweep.h \
     jansson/hashtable.h \
     jansson/jansson.h \
     jansson/jansson_config.h \
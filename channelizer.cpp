@@ -0,0 +1,331 @@
+/* =====================================================================================
+ * Adds BladeRF capability to SDRNode
+ * Copyright (C) 2016 Sylvain AZARIAN <sylvain.azarian@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "channelizer.h"
+
+// channel filter : Kaiser windowed sinc, ~70 dB stop band
+#define KAISER_BETA (6.76)
+#define KAISER_ATTENUATION_DB (70.0)
+
+//-----------------------------------------------------------------------------------------
+// radix-2 complex FFT, in place
+
+struct t_fft {
+    unsigned int n ;
+    TYPECPX *twiddle ;      // exp(-2i.pi.k/n), k < n/2
+    unsigned int *reverse ; // bit reversed indexes
+};
+
+static struct t_fft *fft_create( unsigned int n ) {
+    struct t_fft *f = (struct t_fft *)malloc( sizeof(struct t_fft));
+    if( f == NULL )
+        return(NULL);
+    f->n = n ;
+    f->twiddle = (TYPECPX *)malloc( (n/2 > 0 ? n/2 : 1) * sizeof(TYPECPX));
+    f->reverse = (unsigned int *)malloc( n * sizeof(unsigned int));
+    if( f->twiddle == NULL || f->reverse == NULL ) {
+        free( f->twiddle );
+        free( f->reverse );
+        free( f );
+        return(NULL);
+    }
+    for( unsigned int k=0 ; k < n/2 ; k++ ) {
+        f->twiddle[k].re = (float)cos( 2*M_PI*k/n );
+        f->twiddle[k].im = (float)-sin( 2*M_PI*k/n );
+    }
+    unsigned int bits = 0 ;
+    while( (1u << bits) < n ) bits++ ;
+    for( unsigned int i=0 ; i < n ; i++ ) {
+        unsigned int r = 0 ;
+        for( unsigned int b=0 ; b < bits ; b++ ) {
+            r |= ((i >> b) & 1) << (bits - 1 - b) ;
+        }
+        f->reverse[i] = r ;
+    }
+    return( f );
+}
+
+static void fft_destroy( struct t_fft *f ) {
+    if( f == NULL )
+        return ;
+    free( f->twiddle );
+    free( f->reverse );
+    free( f );
+}
+
+// inverse is not scaled
+static void fft_run( const struct t_fft *f, TYPECPX *x, bool inverse ) {
+    const unsigned int n = f->n ;
+    const float sign = inverse ? -1.0f : 1.0f ;
+
+    for( unsigned int i=0 ; i < n ; i++ ) {
+        unsigned int r = f->reverse[i] ;
+        if( r > i ) {
+            TYPECPX t = x[i] ;
+            x[i] = x[r] ;
+            x[r] = t ;
+        }
+    }
+    for( unsigned int len=2 ; len <= n ; len <<= 1 ) {
+        unsigned int half = len/2 ;
+        unsigned int stride = n/len ;
+        for( unsigned int start=0 ; start < n ; start += len ) {
+            for( unsigned int k=0 ; k < half ; k++ ) {
+                const TYPECPX w = f->twiddle[k*stride] ;
+                const float wi = sign * w.im ;
+                TYPECPX *a = &x[start + k] ;
+                TYPECPX *b = &x[start + k + half] ;
+                float tr = b->re * w.re - b->im * wi ;
+                float ti = b->re * wi + b->im * w.re ;
+                b->re = a->re - tr ;
+                b->im = a->im - ti ;
+                a->re += tr ;
+                a->im += ti ;
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------------------
+
+static double bessel_i0( double x ) {
+    double sum = 1.0 ;
+    double term = 1.0 ;
+    for( int k=1 ; k < 50 ; k++ ) {
+        term *= (x / (2.0*k)) * (x / (2.0*k)) ;
+        sum += term ;
+        if( term < sum * 1e-12 )
+            break ;
+    }
+    return( sum );
+}
+
+/**
+ * @brief channelizer_decimation the output rate must hold the widest channel plus the filter transition
+ * @param fft_size
+ * @param sample_rate
+ * @param bandwidth_hz
+ * @param channels
+ * @return decimation, power of 2 up to fft_size/4, 0 if a channel is wider than the input
+ */
+unsigned int channelizer_decimation( unsigned int fft_size, double sample_rate, const double *bandwidth_hz, int channels ) {
+    double widest = 0 ;
+    for( int c=0 ; c < channels ; c++ ) {
+        if( bandwidth_hz[c] > widest ) widest = bandwidth_hz[c] ;
+    }
+    unsigned int taps = fft_size/4 + 1 ;
+    double transition = sample_rate * (KAISER_ATTENUATION_DB - 8.0) / (14.36 * taps) ;
+    double needed = widest + 2*transition ;
+    if( widest <= 0 || needed > sample_rate )
+        return(0);
+
+    unsigned int decim = 1 ;
+    while( decim*2 <= fft_size/4 && sample_rate / (decim*2) >= needed ) {
+        decim *= 2 ;
+    }
+    return( decim );
+}
+
+/**
+ * @brief channelizer_create
+ * @param fft_size power of 2, 64 or more
+ * @param sample_rate input rate
+ * @param channels
+ * @param offset_hz centre of each channel relative to the tuned frequency
+ * @param bandwidth_hz
+ * @param push_samples input samples per output block
+ * @param max_block_samples capacity of the output blocks
+ * @param emit called for each output block
+ * @param emit_ctx
+ * @return NULL on bad settings or allocation failure
+ */
+struct t_channelizer *channelizer_create( unsigned int fft_size, double sample_rate, int channels,
+                                          const double *offset_hz, const double *bandwidth_hz,
+                                          unsigned int push_samples, unsigned int max_block_samples,
+                                          t_channelizer_emit emit, void *emit_ctx ) {
+    struct t_channelizer *c ;
+
+    if( fft_size < 64 || (fft_size & (fft_size - 1)) != 0 )
+        return(NULL);
+    if( channels <= 0 || channels > CHANNELIZER_MAX_CHANNELS || sample_rate <= 0 )
+        return(NULL);
+    unsigned int decim = channelizer_decimation( fft_size, sample_rate, bandwidth_hz, channels );
+    if( decim == 0 )
+        return(NULL);
+
+    c = (struct t_channelizer *)malloc( sizeof(struct t_channelizer));
+    if( c == NULL )
+        return(NULL);
+    memset( c, 0, sizeof(struct t_channelizer));
+    c->fft_size = fft_size ;
+    c->step = fft_size - fft_size/4 ;
+    c->decim = decim ;
+    c->channels = channels ;
+    c->emit = emit ;
+    c->emit_ctx = emit_ctx ;
+
+    // output blocks : whole frames, about push_samples input samples
+    unsigned int frame_out = c->step / decim ;
+    unsigned int frames = push_samples / c->step ;
+    if( frames == 0 ) frames = 1 ;
+    while( frames > 1 && frames * frame_out * channels > max_block_samples ) {
+        frames-- ;
+    }
+    c->block_len = frames * frame_out ;
+    if( c->block_len * channels > max_block_samples ) {
+        free( c );
+        return(NULL);
+    }
+
+    unsigned int bins = fft_size / decim ;
+    c->fft = fft_create( fft_size );
+    c->ifft = fft_create( bins );
+    c->response = (TYPECPX *)malloc( channels * bins * sizeof(TYPECPX));
+    c->frame = (TYPECPX *)malloc( fft_size * sizeof(TYPECPX));
+    c->spectrum = (TYPECPX *)malloc( fft_size * sizeof(TYPECPX));
+    c->small = (TYPECPX *)malloc( bins * sizeof(TYPECPX));
+    c->out = (TYPECPX *)malloc( channels * c->block_len * sizeof(TYPECPX));
+    if( c->fft == NULL || c->ifft == NULL || c->response == NULL || c->frame == NULL ||
+        c->spectrum == NULL || c->small == NULL || c->out == NULL ) {
+        channelizer_destroy( c );
+        return(NULL);
+    }
+    memset( c->frame, 0, fft_size * sizeof(TYPECPX));
+    c->fill = fft_size - c->step ;
+
+    // filters : causal fft_size/4 + 1 taps, zero padded, scaled by 1/fft_size for the inverse FFT
+    unsigned int taps = fft_size/4 + 1 ;
+    double center = (taps - 1) / 2.0 ;
+    double i0_beta = bessel_i0( KAISER_BETA );
+    for( int ch=0 ; ch < channels ; ch++ ) {
+        double fc = bandwidth_hz[ch] / 2.0 / sample_rate ;
+        double sum = 0 ;
+        memset( c->spectrum, 0, fft_size * sizeof(TYPECPX));
+        for( unsigned int n=0 ; n < taps ; n++ ) {
+            double t = n - center ;
+            double r = t / center ;
+            double sinc = t == 0 ? 2*fc : sin( 2*M_PI*fc*t ) / (M_PI*t) ;
+            double w = bessel_i0( KAISER_BETA * sqrt( fmax( 0.0, 1.0 - r*r ))) / i0_beta ;
+            c->spectrum[n].re = (float)(sinc * w) ;
+            sum += sinc * w ;
+        }
+        for( unsigned int n=0 ; n < taps ; n++ ) {
+            c->spectrum[n].re = (float)(c->spectrum[n].re / (sum * fft_size)) ;
+        }
+        fft_run( c->fft, c->spectrum, false );
+        // keep the bins around DC, in inverse FFT order
+        for( unsigned int i=0 ; i < bins ; i++ ) {
+            int k = (int)i < (int)bins/2 ? (int)i : (int)i - (int)bins ;
+            c->response[ ch*bins + i ] = c->spectrum[ (k + fft_size) % fft_size ] ;
+        }
+
+        int bin = (int)lround( offset_hz[ch] / sample_rate * fft_size ) ;
+        c->bins[ch] = bin ;
+        c->phase[ch] = 0 ;
+    }
+    return( c );
+}
+
+void channelizer_destroy( struct t_channelizer *c ) {
+    if( c == NULL )
+        return ;
+    fft_destroy( c->fft );
+    fft_destroy( c->ifft );
+    free( c->response );
+    free( c->frame );
+    free( c->spectrum );
+    free( c->small );
+    free( c->out );
+    free( c );
+}
+
+double channelizer_offset_hz( const struct t_channelizer *c, int channel, double sample_rate ) {
+    return( c->bins[channel] * sample_rate / c->fft_size );
+}
+
+// one overlap-save frame : fft_size samples in c->frame
+static void run_frame( struct t_channelizer *c ) {
+    const unsigned int n = c->fft_size ;
+    const unsigned int bins = n / c->decim ;
+    const unsigned int discard = (n - c->step) / c->decim ;
+    const unsigned int frame_out = c->step / c->decim ;
+
+    memcpy( c->spectrum, c->frame, n * sizeof(TYPECPX));
+    fft_run( c->fft, c->spectrum, false );
+
+    for( int ch=0 ; ch < c->channels ; ch++ ) {
+        const TYPECPX *h = c->response + ch*bins ;
+        for( unsigned int i=0 ; i < bins ; i++ ) {
+            int k = (int)i < (int)bins/2 ? (int)i : (int)i - (int)bins ;
+            const TYPECPX x = c->spectrum[ (unsigned int)(c->bins[ch] + k + (int)n) % n ] ;
+            c->small[i].re = x.re * h[i].re - x.im * h[i].im ;
+            c->small[i].im = x.re * h[i].im + x.im * h[i].re ;
+        }
+        fft_run( c->ifft, c->small, true );
+
+        // the shift to baseband restarts at each frame : rotate by the phase of the frame start
+        // in the input stream, exp(-2i.pi.bin.start/n), from the forward twiddles
+        unsigned int ph = c->phase[ch] ;
+        TYPECPX w ;
+        if( ph < n/2 ) {
+            w = c->fft->twiddle[ph] ;
+        } else {
+            w.re = -c->fft->twiddle[ph - n/2].re ;
+            w.im = -c->fft->twiddle[ph - n/2].im ;
+        }
+        TYPECPX *dst = c->out + ch*c->block_len + c->out_fill ;
+        for( unsigned int i=0 ; i < frame_out ; i++ ) {
+            const TYPECPX y = c->small[ discard + i ] ;
+            dst[i].re = y.re * w.re - y.im * w.im ;
+            dst[i].im = y.re * w.im + y.im * w.re ;
+        }
+        int64_t next = (int64_t)ph + (int64_t)c->bins[ch] * c->step ;
+        next %= (int64_t)n ;
+        if( next < 0 ) next += n ;
+        c->phase[ch] = (unsigned int)next ;
+    }
+    c->out_fill += frame_out ;
+    if( c->out_fill == c->block_len ) {
+        (*c->emit)( c->emit_ctx, c->out, c->block_len, c->channels, c->out_position * c->decim );
+        c->out_position += c->block_len ;
+        c->out_fill = 0 ;
+    }
+
+    // keep the overlap for the next frame
+    memmove( c->frame, c->frame + c->step, (n - c->step) * sizeof(TYPECPX));
+    c->fill = n - c->step ;
+}
+
+void channelizer_process( struct t_channelizer *c, const TYPECPX *in, int count ) {
+    while( count > 0 ) {
+        unsigned int n = c->fft_size - c->fill ;
+        if( n > (unsigned int)count ) n = count ;
+        memcpy( c->frame + c->fill, in, n * sizeof(TYPECPX));
+        c->fill += n ;
+        c->consumed += n ;
+        in += n ;
+        count -= n ;
+        if( c->fill == c->fft_size ) {
+            run_frame( c );
+        }
+    }
+}
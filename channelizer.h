@@ -0,0 +1,83 @@
+/* =====================================================================================
+ * Adds BladeRF capability to SDRNode
+ * Copyright (C) 2016 Sylvain AZARIAN <sylvain.azarian@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef CHANNELIZER_H
+#define CHANNELIZER_H
+
+#include <stdint.h>
+#include "dsp_kernels.h"
+
+/*
+ * Overlap-save FFT channelizer : one forward FFT of fft_size points per frame is shared by all
+ * the channels. Each channel takes the fft_size/decim bins around its centre, applies its low
+ * pass filter (fft_size/4 + 1 taps) in the frequency domain and goes back to the time domain
+ * with a small inverse FFT, which also decimates. A frame consumes 3/4 * fft_size input samples.
+ * Channel centres are rounded to the FFT bin spacing. All channels share the output rate
+ * input rate / decim, picked from the widest channel.
+ * Output blocks hold block_len samples of channel 0, then block_len samples of channel 1...
+ * block_len covers about push_samples input samples, channels * block_len stays below
+ * max_block_samples.
+ * Output sample i of a channel lines up with input sample i * decim.
+ */
+
+#define CHANNELIZER_MAX_CHANNELS (32)
+#define CHANNELIZER_DEFAULT_FFT_SIZE (4096)
+
+struct t_fft ;
+
+// called with each complete output block, position : index of the input sample its first sample lines up with
+typedef void (*t_channelizer_emit)( void *ctx, TYPECPX *block, int block_len, int channels, uint64_t position );
+
+struct t_channelizer {
+    unsigned int fft_size ;
+    unsigned int step ;         // new input samples per frame
+    unsigned int decim ;
+    int channels ;
+    int bins[CHANNELIZER_MAX_CHANNELS] ;      // centre of each channel, in FFT bins
+    unsigned int phase[CHANNELIZER_MAX_CHANNELS] ; // frame start phase of each channel, in 1/fft_size turns
+    TYPECPX *response ;         // channels * fft_size/decim filter bins, scaled by 1/fft_size
+    struct t_fft *fft ;
+    struct t_fft *ifft ;        // fft_size/decim points
+    TYPECPX *frame ;            // overlap followed by the new samples
+    unsigned int fill ;         // samples in frame
+    uint64_t consumed ;         // input samples taken since creation
+    TYPECPX *spectrum ;
+    TYPECPX *small ;
+
+    TYPECPX *out ;              // channels * block_len
+    unsigned int block_len ;
+    unsigned int out_fill ;
+    uint64_t out_position ;     // output samples emitted per channel, before out
+    t_channelizer_emit emit ;
+    void *emit_ctx ;
+};
+
+// largest decimation keeping the widest channel, 0 if the settings do not fit
+unsigned int channelizer_decimation( unsigned int fft_size, double sample_rate, const double *bandwidth_hz, int channels );
+
+struct t_channelizer *channelizer_create( unsigned int fft_size, double sample_rate, int channels,
+                                          const double *offset_hz, const double *bandwidth_hz,
+                                          unsigned int push_samples, unsigned int max_block_samples,
+                                          t_channelizer_emit emit, void *emit_ctx );
+void channelizer_destroy( struct t_channelizer *c );
+
+// actual centre of a channel after rounding to the bin spacing
+double channelizer_offset_hz( const struct t_channelizer *c, int channel, double sample_rate );
+
+void channelizer_process( struct t_channelizer *c, const TYPECPX *in, int count );
+
+#endif // CHANNELIZER_H
@@ -0,0 +1,84 @@
+/* =====================================================================================
+ * Adds BladeRF capability to SDRNode
+ * Copyright (C) 2016 Sylvain AZARIAN <sylvain.azarian@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string.h>
+
+#include "control_queue.h"
+
+#define CONTROL_QUEUE_MASK (CONTROL_QUEUE_DEPTH - 1)
+
+// cell i is free for position p when its sequence is p, ready for the consumer when it is p+1
+void control_queue_init( struct t_control_queue *q ) {
+    memset( q, 0, sizeof(struct t_control_queue));
+    for( unsigned int i=0 ; i < CONTROL_QUEUE_DEPTH ; i++ ) {
+        q->cells[i].sequence = i ;
+    }
+    q->head = 0 ;
+    q->tail = 0 ;
+}
+
+/**
+ * @brief control_queue_push claims the next position and publishes the command in its cell
+ * @param q
+ * @param cmd
+ * @return false if the queue is full
+ */
+bool control_queue_push( struct t_control_queue *q, const struct t_control_cmd *cmd ) {
+    unsigned int pos = __atomic_load_n( &q->head, __ATOMIC_RELAXED );
+    struct t_control_cell *cell ;
+
+    for( ;; ) {
+        cell = &q->cells[pos & CONTROL_QUEUE_MASK] ;
+        unsigned int seq = __atomic_load_n( &cell->sequence, __ATOMIC_ACQUIRE );
+        int diff = (int)(seq - pos) ;
+        if( diff == 0 ) {
+            if( __atomic_compare_exchange_n( &q->head, &pos, pos + 1, true, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED )) {
+                break ;
+            }
+            // pos was reloaded by the failed exchange
+        } else if( diff < 0 ) {
+            return( false ); // the consumer has not freed this cell yet
+        } else {
+            pos = __atomic_load_n( &q->head, __ATOMIC_RELAXED );
+        }
+    }
+    cell->cmd = *cmd ;
+    __atomic_store_n( &cell->sequence, pos + 1, __ATOMIC_SEQ_CST );
+    return( true );
+}
+
+bool control_queue_pop( struct t_control_queue *q, struct t_control_cmd *cmd ) {
+    unsigned int tail = __atomic_load_n( &q->tail, __ATOMIC_RELAXED );
+    struct t_control_cell *cell = &q->cells[tail & CONTROL_QUEUE_MASK] ;
+    if( __atomic_load_n( &cell->sequence, __ATOMIC_ACQUIRE ) != tail + 1 ) {
+        return( false );
+    }
+    *cmd = cell->cmd ;
+    __atomic_store_n( &cell->sequence, tail + CONTROL_QUEUE_DEPTH, __ATOMIC_RELEASE );
+    __atomic_store_n( &q->tail, tail + 1, __ATOMIC_RELEASE );
+    return( true );
+}
+
+/**
+ * @brief control_queue_empty true if no command is ready. Also safe as a hint from a thread which is
+ *        not the consumer, the consumer role being handed over with an atomic flag
+ */
+bool control_queue_empty( struct t_control_queue *q ) {
+    unsigned int tail = __atomic_load_n( &q->tail, __ATOMIC_ACQUIRE );
+    struct t_control_cell *cell = &q->cells[tail & CONTROL_QUEUE_MASK] ;
+    return( __atomic_load_n( &cell->sequence, __ATOMIC_SEQ_CST ) != tail + 1 );
+}
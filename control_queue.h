@@ -0,0 +1,65 @@
+/* =====================================================================================
+ * Adds BladeRF capability to SDRNode
+ * Copyright (C) 2016 Sylvain AZARIAN <sylvain.azarian@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef CONTROL_QUEUE_H
+#define CONTROL_QUEUE_H
+
+#include <stdint.h>
+
+/*
+ * Bounded multiple producer / single consumer queue of control commands.
+ * SDRNode threads push, the thread owning the device pops. Each cell carries a sequence
+ * number telling whether it is free for the producer holding that position or ready for the
+ * consumer, so neither side takes a lock. A full queue rejects the command.
+ */
+
+#define CONTROL_QUEUE_DEPTH (64) // power of 2
+
+#define CONTROL_SET_SAMPLE_RATE (0)
+#define CONTROL_SET_FREQUENCY   (1)
+#define CONTROL_SET_GAIN        (2)
+
+struct t_control_cmd {
+    int type ;
+    int stage ;      // CONTROL_SET_GAIN
+    int64_t value ;  // rate or frequency, in Hz
+    float gain ;
+};
+
+struct t_control_cell {
+    volatile unsigned int sequence ;
+    struct t_control_cmd cmd ;
+};
+
+struct t_control_queue {
+    struct t_control_cell cells[CONTROL_QUEUE_DEPTH] ;
+    volatile unsigned int head ; // next position to push, shared by the producers
+    volatile unsigned int tail ; // next position to pop, written by the consumer only
+};
+
+void control_queue_init( struct t_control_queue *q );
+
+// any thread, false if the queue is full
+bool control_queue_push( struct t_control_queue *q, const struct t_control_cmd *cmd );
+
+// consumer only, false if nothing is ready
+bool control_queue_pop( struct t_control_queue *q, struct t_control_cmd *cmd );
+
+// consumer, or any thread as a hint
+bool control_queue_empty( struct t_control_queue *q );
+
+#endif // CONTROL_QUEUE_H
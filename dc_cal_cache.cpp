@@ -0,0 +1,146 @@
+/* =====================================================================================
+ * Adds BladeRF capability to SDRNode
+ * Copyright (C) 2016 Sylvain AZARIAN <sylvain.azarian@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "jansson/jansson.h"
+#include "dc_cal_cache.h"
+
+#define DC_CAL_PATH_LEN (DC_CAL_DIR_LEN + 64)
+
+// register fields in file order
+static const char *field_names[] = {
+    "lpf_tuning", "tx_lpf_i", "tx_lpf_q", "rx_lpf_i", "rx_lpf_q",
+    "dc_ref", "rxvga2a_i", "rxvga2a_q", "rxvga2b_i", "rxvga2b_q"
+};
+#define FIELD_COUNT (10)
+
+static void fields( struct bladerf_lms_dc_cals *cals, int16_t **f ) {
+    f[0] = &cals->lpf_tuning ;
+    f[1] = &cals->tx_lpf_i ;
+    f[2] = &cals->tx_lpf_q ;
+    f[3] = &cals->rx_lpf_i ;
+    f[4] = &cals->rx_lpf_q ;
+    f[5] = &cals->dc_ref ;
+    f[6] = &cals->rxvga2a_i ;
+    f[7] = &cals->rxvga2a_q ;
+    f[8] = &cals->rxvga2b_i ;
+    f[9] = &cals->rxvga2b_q ;
+}
+
+static void cache_path( char *path, const char *dir, const char *serial ) {
+    snprintf( path, DC_CAL_PATH_LEN, "%s/bladerf_dccal_%s.json", dir, serial );
+}
+
+/**
+ * @brief dc_cal_cache_load
+ * @param dir cache directory
+ * @param serial device serial number
+ * @param fpga_version entry is ignored if written with another FPGA
+ * @param max_age_s entry is ignored if older, 0 : no limit
+ * @param cals
+ * @return 0 if cals holds a usable entry
+ */
+int dc_cal_cache_load( const char *dir, const char *serial, const char *fpga_version,
+                       unsigned int max_age_s, struct bladerf_lms_dc_cals *cals ) {
+    char path[DC_CAL_PATH_LEN] ;
+    json_error_t error ;
+    int16_t *f[FIELD_COUNT] ;
+
+    if( dir == NULL || dir[0] == 0 )
+        return(-1);
+
+    cache_path( path, dir, serial );
+    json_t *root = json_load_file( path, 0, &error );
+    if( root == NULL )
+        return(-1);
+
+    const char *fpga = json_string_value( json_object_get( root, "fpga" ));
+    json_t *when = json_object_get( root, "time" );
+    if( fpga == NULL || strcmp( fpga, fpga_version ) != 0 || !json_is_integer( when )) {
+        json_decref( root );
+        return(-1);
+    }
+    json_int_t age = (json_int_t)time(NULL) - json_integer_value( when );
+    if( age < 0 || (max_age_s > 0 && age > (json_int_t)max_age_s)) {
+        json_decref( root );
+        return(-1);
+    }
+
+    struct bladerf_lms_dc_cals values ;
+    fields( &values, f );
+    for( int i=0 ; i < FIELD_COUNT ; i++ ) {
+        json_t *value = json_object_get( root, field_names[i] );
+        if( !json_is_integer( value )) {
+            json_decref( root );
+            return(-1);
+        }
+        *f[i] = (int16_t)json_integer_value( value );
+    }
+    json_decref( root );
+    *cals = values ;
+    return(0);
+}
+
+/**
+ * @brief dc_cal_cache_store writes the entry of a device, replacing the previous one
+ * @param dir cache directory, must exist
+ * @param serial
+ * @param fpga_version
+ * @param cals
+ * @return 0 on success
+ */
+int dc_cal_cache_store( const char *dir, const char *serial, const char *fpga_version,
+                        const struct bladerf_lms_dc_cals *cals ) {
+    char path[DC_CAL_PATH_LEN] ;
+    char tmp_path[DC_CAL_PATH_LEN + 8] ;
+    struct bladerf_lms_dc_cals copy = *cals ;
+    int16_t *f[FIELD_COUNT] ;
+
+    if( dir == NULL || dir[0] == 0 )
+        return(-1);
+
+    json_t *root = json_object();
+    if( root == NULL )
+        return(-1);
+    json_object_set_new( root, "serial", json_string( serial ));
+    json_object_set_new( root, "fpga", json_string( fpga_version ));
+    json_object_set_new( root, "time", json_integer( (json_int_t)time(NULL) ));
+    fields( &copy, f );
+    for( int i=0 ; i < FIELD_COUNT ; i++ ) {
+        json_object_set_new( root, field_names[i], json_integer( *f[i] ));
+    }
+
+    cache_path( path, dir, serial );
+    snprintf( tmp_path, sizeof(tmp_path), "%s.tmp", path );
+    int rc = json_dump_file( root, tmp_path, JSON_INDENT(2));
+    json_decref( root );
+    if( rc != 0 ) {
+        remove( tmp_path );
+        return(-1);
+    }
+#ifdef _WIN64
+    remove( path ); // rename() does not replace on Windows
+#endif
+    if( rename( tmp_path, path ) != 0 ) {
+        remove( tmp_path );
+        return(-1);
+    }
+    return(0);
+}
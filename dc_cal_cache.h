@@ -0,0 +1,42 @@
+/* =====================================================================================
+ * Adds BladeRF capability to SDRNode
+ * Copyright (C) 2016 Sylvain AZARIAN <sylvain.azarian@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DC_CAL_CACHE_H
+#define DC_CAL_CACHE_H
+
+#include "BladeRF/nuand/libbladeRF.h"
+
+/*
+ * LMS6002D DC calibration results kept on disk, one JSON file per serial number :
+ *   <dir>/bladerf_dccal_<serial>.json
+ * An entry is used only for the same FPGA version and while it is younger than max_age_s.
+ * The board has no temperature sensor, so the age bounds the drift since the calibration.
+ * Files are replaced atomically (written aside then renamed), a damaged file is a miss.
+ */
+
+#define DC_CAL_DIR_LEN (256)
+#define DC_CAL_DEFAULT_MAX_AGE_S (86400)
+
+// 0 and cals filled if a fresh entry exists, -1 otherwise
+int dc_cal_cache_load( const char *dir, const char *serial, const char *fpga_version,
+                       unsigned int max_age_s, struct bladerf_lms_dc_cals *cals );
+
+// 0 on success, -1 if the file could not be written
+int dc_cal_cache_store( const char *dir, const char *serial, const char *fpga_version,
+                        const struct bladerf_lms_dc_cals *cals );
+
+#endif // DC_CAL_CACHE_H
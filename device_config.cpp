@@ -0,0 +1,312 @@
+/* =====================================================================================
+ * Adds BladeRF capability to SDRNode
+ * Copyright (C) 2016 Sylvain AZARIAN <sylvain.azarian@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <sched.h>
+
+#include "device_config.h"
+#include "sample_pool.h"
+
+// auto profile : samples kept in flight in USB transfers, to ride through scheduling hiccups
+#define AUTO_INFLIGHT_US   (20000)
+#define AUTO_MIN_TRANSFERS (4)
+#define AUTO_MAX_TRANSFERS (32)
+
+static int getJsonInt( json_t *obj, const char *key, int default_value ) {
+    json_t *value = json_object_get( obj, key );
+    if( json_is_integer( value )) {
+        return( (int)json_integer_value( value ));
+    }
+    return( default_value );
+}
+
+static double getJsonDouble( json_t *obj, const char *key, double default_value ) {
+    json_t *value = json_object_get( obj, key );
+    if( json_is_number( value )) {
+        return( json_number_value( value ));
+    }
+    return( default_value );
+}
+
+static bool getJsonBool( json_t *obj, const char *key, bool default_value ) {
+    json_t *value = json_object_get( obj, key );
+    if( json_is_boolean( value )) {
+        return( json_is_true( value ));
+    }
+    return( default_value );
+}
+
+/**
+ * @brief getJsonCpus reads a CPU list given either as a string ("0-3,8") or as a single integer
+ */
+static void getJsonCpus( json_t *obj, const char *key, char *cpus, size_t len ) {
+    json_t *value = json_object_get( obj, key );
+    if( json_is_string( value )) {
+        snprintf( cpus, len, "%s", json_string_value( value ));
+    } else if( json_is_integer( value )) {
+        snprintf( cpus, len, "%d", (int)json_integer_value( value ));
+    }
+}
+
+/**
+ * @brief read_layer applies the keys found in obj on top of cfg
+ *        "rx_engine" : "sync" | "stream", "ring_depth" : 0 | 16, "dc_alpha" : 0.9996, "resampler" : false,
+ *        "sample_pool" : { "blocks" : 32, "host_release" : false },
+ *        "offset_tuning" : { "enabled" : true, "lo_offset_hz" : 0, "max_offset_hz" : 0 },
+ *        "quick_tune" : { "enabled" : true, "scheduled" : true, "lead_us" : 1000, "prewarm_hz" : [ 433920000, ... ] },
+ *        "channelizer" : { "fft_size" : 4096, "channels" : [ { "offset_hz" : -250000, "bandwidth_hz" : 25000 }, ... ] },
+ *        "stream" : { "profile" : "fixed" | "auto", "target_latency_us" : 4000, "buffers" : 32,
+ *                     "buffer_size" : 32768, "transfers" : 16, "timeout_ms" : 5000, "push_samples" : 8192,
+ *                     "overrun_wait_us" : 0, "wake_batch" : 1, "spin_us" : 0 },
+ *        "affinity" : { "acquisition" : "2", "sync_worker" : "3", "dsp" : "4-5" },
+ *        "sched_policy" : "fifo" | "rr" | "other", "sched_priority" : 50,
+ *        "numa_node" : "auto" | <node>,
+ *        "dc_cal_cache" : { "dir" : "/var/cache/sdrnode", "max_age_s" : 86400 },
+ *        "standby" : { "idle_timeout_ms" : 10000 }
+ * @param obj
+ * @param usb_bus used to find the USB controller NUMA node
+ * @param cfg
+ */
+static void read_layer( json_t *obj, int usb_bus, struct t_device_config *cfg ) {
+    struct t_thread_placement *p = &cfg->placement ;
+    struct t_stream_geometry *g = &cfg->geometry ;
+
+    if( !json_is_object( obj ))
+        return ;
+
+    const char *engine = json_string_value( json_object_get( obj, "rx_engine" ));
+    if( engine != NULL ) {
+        cfg->rx_engine = strcmp( engine, "stream" ) == 0 ? RX_ENGINE_STREAM : RX_ENGINE_SYNC ;
+    }
+    cfg->ring_depth = getJsonInt( obj, "ring_depth", cfg->ring_depth );
+    cfg->dc_alpha = getJsonDouble( obj, "dc_alpha", cfg->dc_alpha );
+    cfg->resampler = getJsonBool( obj, "resampler", cfg->resampler );
+
+    json_t *pool = json_object_get( obj, "sample_pool" );
+    cfg->pool_blocks = getJsonInt( pool, "blocks", cfg->pool_blocks );
+    cfg->pool_host_release = getJsonBool( pool, "host_release", cfg->pool_host_release );
+
+    json_t *offset = json_object_get( obj, "offset_tuning" );
+    cfg->offset_tuning = getJsonBool( offset, "enabled", cfg->offset_tuning );
+    if( json_is_integer( json_object_get( offset, "lo_offset_hz" ))) {
+        cfg->lo_offset_hz = json_integer_value( json_object_get( offset, "lo_offset_hz" ));
+    }
+    if( json_is_integer( json_object_get( offset, "max_offset_hz" ))) {
+        cfg->max_offset_hz = json_integer_value( json_object_get( offset, "max_offset_hz" ));
+    }
+
+    json_t *quick = json_object_get( obj, "quick_tune" );
+    cfg->quick_tune = getJsonBool( quick, "enabled", cfg->quick_tune );
+    cfg->scheduled_retune = getJsonBool( quick, "scheduled", cfg->scheduled_retune );
+    cfg->retune_lead_us = (unsigned int)getJsonInt( quick, "lead_us", (int)cfg->retune_lead_us );
+    json_t *prewarm = json_object_get( quick, "prewarm_hz" );
+    if( json_is_array( prewarm )) {
+        cfg->prewarm_count = 0 ;
+        for( size_t i=0 ; i < json_array_size( prewarm ) && cfg->prewarm_count < TUNE_CACHE_ENTRIES ; i++ ) {
+            json_t *frq = json_array_get( prewarm, i );
+            if( json_is_integer( frq ) && json_integer_value( frq ) > 0 ) {
+                cfg->prewarm_hz[cfg->prewarm_count++] = (unsigned int)json_integer_value( frq );
+            }
+        }
+    }
+
+    json_t *channelizer = json_object_get( obj, "channelizer" );
+    cfg->channelizer_fft_size = (unsigned int)getJsonInt( channelizer, "fft_size", (int)cfg->channelizer_fft_size );
+    json_t *channels = json_object_get( channelizer, "channels" );
+    if( json_is_array( channels )) {
+        cfg->channel_count = 0 ;
+        for( size_t i=0 ; i < json_array_size( channels ) && cfg->channel_count < CHANNELIZER_MAX_CHANNELS ; i++ ) {
+            json_t *ch = json_array_get( channels, i );
+            double bw = getJsonDouble( ch, "bandwidth_hz", 0 );
+            if( bw <= 0 )
+                continue ;
+            cfg->channel_offset_hz[cfg->channel_count] = getJsonDouble( ch, "offset_hz", 0 );
+            cfg->channel_bandwidth_hz[cfg->channel_count] = bw ;
+            cfg->channel_count++ ;
+        }
+    }
+
+    json_t *stream = json_object_get( obj, "stream" );
+    const char *profile = json_string_value( json_object_get( stream, "profile" ));
+    if( profile != NULL ) {
+        cfg->stream_profile = strcmp( profile, "auto" ) == 0 ? STREAM_PROFILE_AUTO : STREAM_PROFILE_FIXED ;
+    }
+    cfg->target_latency_us = (unsigned int)getJsonInt( stream, "target_latency_us", (int)cfg->target_latency_us );
+    g->num_buffers = (unsigned int)getJsonInt( stream, "buffers", (int)g->num_buffers );
+    g->buffer_size = (unsigned int)getJsonInt( stream, "buffer_size", (int)g->buffer_size );
+    g->num_transfers = (unsigned int)getJsonInt( stream, "transfers", (int)g->num_transfers );
+    g->timeout_ms = (unsigned int)getJsonInt( stream, "timeout_ms", (int)g->timeout_ms );
+    g->push_samples = (unsigned int)getJsonInt( stream, "push_samples", (int)g->push_samples );
+    cfg->overrun_wait_us = (unsigned int)getJsonInt( stream, "overrun_wait_us", (int)cfg->overrun_wait_us );
+    cfg->wake_batch = (unsigned int)getJsonInt( stream, "wake_batch", (int)cfg->wake_batch );
+    cfg->spin_us = (unsigned int)getJsonInt( stream, "spin_us", (int)cfg->spin_us );
+
+    json_t *affinity = json_object_get( obj, "affinity" );
+    getJsonCpus( affinity, "acquisition", p->cpus[PLACEMENT_THREAD_ACQUISITION], PLACEMENT_CPUS_LEN );
+    getJsonCpus( affinity, "sync_worker", p->cpus[PLACEMENT_THREAD_SYNC_WORKER], PLACEMENT_CPUS_LEN );
+    getJsonCpus( affinity, "dsp", p->cpus[PLACEMENT_THREAD_DSP], PLACEMENT_CPUS_LEN );
+
+    const char *policy = json_string_value( json_object_get( obj, "sched_policy" ));
+    if( policy != NULL ) {
+        if( strcmp( policy, "fifo" ) == 0 ) {
+            p->policy = SCHED_FIFO ;
+        } else if( strcmp( policy, "rr" ) == 0 ) {
+            p->policy = SCHED_RR ;
+        } else {
+            p->policy = SCHED_OTHER ;
+        }
+    }
+    p->priority = getJsonInt( obj, "sched_priority", p->priority );
+
+    json_t *dccal = json_object_get( obj, "dc_cal_cache" );
+    const char *dir = json_string_value( json_object_get( dccal, "dir" ));
+    if( dir != NULL ) {
+        snprintf( cfg->dc_cal_dir, DC_CAL_DIR_LEN, "%s", dir );
+    }
+    cfg->dc_cal_max_age_s = (unsigned int)getJsonInt( dccal, "max_age_s", (int)cfg->dc_cal_max_age_s );
+
+    json_t *standby = json_object_get( obj, "standby" );
+    cfg->standby_timeout_ms = (unsigned int)getJsonInt( standby, "idle_timeout_ms", (int)cfg->standby_timeout_ms );
+
+    json_t *node = json_object_get( obj, "numa_node" );
+    if( json_is_integer( node )) {
+        p->numa_node = (int)json_integer_value( node );
+    } else if( json_is_string( node ) && strcmp( json_string_value( node ), "auto" ) == 0 ) {
+        p->numa_node = placement_usb_numa_node( usb_bus );
+    }
+}
+
+/**
+ * @brief device_config_read builds the configuration of one device : defaults, then the root
+ *        level keys, then the keys of "devices" : { "<serial>" : { ... } }
+ * @param root
+ * @param serial
+ * @param usb_bus
+ * @param cfg
+ */
+void device_config_read( json_t *root, const char *serial, int usb_bus, struct t_device_config *cfg ) {
+    memset( cfg, 0, sizeof(struct t_device_config));
+    cfg->rx_engine = RX_ENGINE_SYNC ;
+    cfg->ring_depth = 0 ;    // opt-in : the ring costs one extra copy per block
+    cfg->pool_blocks = SAMPLE_POOL_DEFAULT_BLOCKS ;
+    cfg->pool_host_release = false ;
+    cfg->dc_alpha = ALPHA_DC ;
+    cfg->resampler = false ;
+    cfg->offset_tuning = false ;
+    cfg->lo_offset_hz = 0 ;
+    cfg->max_offset_hz = 0 ;
+    cfg->quick_tune = false ;
+    cfg->scheduled_retune = true ;
+    cfg->retune_lead_us = DEFAULT_RETUNE_LEAD_US ;
+    cfg->prewarm_count = 0 ;
+    cfg->channelizer_fft_size = CHANNELIZER_DEFAULT_FFT_SIZE ;
+    cfg->channel_count = 0 ;
+
+    cfg->stream_profile = STREAM_PROFILE_FIXED ;
+    cfg->target_latency_us = DEFAULT_TARGET_LATENCY_US ;
+    cfg->geometry.num_buffers = DEFAULT_STREAM_BUFFERS ;
+    cfg->geometry.buffer_size = DEFAULT_STREAM_BUFFERSIZE ;
+    cfg->geometry.num_transfers = DEFAULT_STREAM_NUMTRANSFERS ;
+    cfg->geometry.timeout_ms = DEFAULT_STREAM_TIMEOUT ;
+    cfg->geometry.push_samples = DEFAULT_STREAM_SAMPLES ;
+    cfg->overrun_wait_us = 0 ;
+    cfg->wake_batch = 1 ;
+    cfg->spin_us = 0 ;
+
+    placement_init( &cfg->placement );
+    cfg->placement.priority = -1 ;
+    cfg->dc_cal_dir[0] = 0 ;
+    cfg->dc_cal_max_age_s = DC_CAL_DEFAULT_MAX_AGE_S ;
+    cfg->standby_timeout_ms = 0 ;
+
+    read_layer( root, usb_bus, cfg );
+    read_layer( json_object_get( json_object_get( root, "devices" ), serial ), usb_bus, cfg );
+
+    // DC blocker pole, closer to 1 means a narrower notch at 0 Hz
+    if( cfg->dc_alpha < 0 || cfg->dc_alpha >= 1.0 ) {
+        cfg->dc_alpha = ALPHA_DC ;
+    }
+    if( cfg->ring_depth < 0 ) {
+        cfg->ring_depth = 0 ;
+    }
+    if( cfg->target_latency_us == 0 ) {
+        cfg->target_latency_us = DEFAULT_TARGET_LATENCY_US ;
+    }
+    if( cfg->placement.priority < 0 ) {
+        cfg->placement.priority = cfg->placement.policy != SCHED_OTHER ?
+                    sched_get_priority_min( cfg->placement.policy ) : 0 ;
+    }
+    placement_bind_node( &cfg->placement );
+}
+
+/**
+ * @brief device_config_bringup_workers how many devices initLibrary brings up at the same time
+ * @param root may be NULL
+ * @return at least 1
+ */
+int device_config_bringup_workers( json_t *root ) {
+    int workers = getJsonInt( root, "bringup_workers", DEFAULT_BRINGUP_WORKERS );
+    return( workers < 1 ? 1 : workers );
+}
+
+static unsigned int clamp( unsigned int v, unsigned int min, unsigned int max ) {
+    if( v < min ) return( min );
+    if( v > max ) return( max );
+    return( v );
+}
+
+void device_config_geometry( const struct t_device_config *cfg, unsigned int sample_rate,
+                             struct t_stream_geometry *geometry ) {
+    struct t_stream_geometry g = cfg->geometry ;
+
+    if( cfg->stream_profile == STREAM_PROFILE_AUTO && sample_rate > 0 ) {
+        // one USB buffer per pushed block : a buffer is only handed over once full so its
+        // duration adds to the latency, and larger blocks only add callback delay
+        uint64_t push = (uint64_t)sample_rate * cfg->target_latency_us / 1000000 ;
+        if( push > STREAM_MAX_PUSH_SAMPLES ) {
+            push = STREAM_MAX_PUSH_SAMPLES ;
+        }
+        push -= push % STREAM_BUFFER_ALIGN ;
+        g.push_samples = clamp( (unsigned int)push, STREAM_BUFFER_ALIGN, STREAM_MAX_PUSH_SAMPLES );
+        g.buffer_size = g.push_samples ;
+
+        // overrun resistance comes from the transfers queued in the controller
+        uint64_t inflight = (uint64_t)sample_rate * AUTO_INFLIGHT_US / 1000000 ;
+        g.num_transfers = clamp( (unsigned int)((inflight + g.buffer_size - 1) / g.buffer_size),
+                                 AUTO_MIN_TRANSFERS, AUTO_MAX_TRANSFERS );
+        g.num_buffers = 2 * g.num_transfers ;
+    }
+
+    g.buffer_size += STREAM_BUFFER_ALIGN - 1 ;
+    g.buffer_size -= g.buffer_size % STREAM_BUFFER_ALIGN ;
+    if( g.buffer_size == 0 ) {
+        g.buffer_size = STREAM_BUFFER_ALIGN ;
+    }
+    if( g.num_transfers == 0 ) {
+        g.num_transfers = 1 ;
+    }
+    if( g.num_buffers <= g.num_transfers ) {
+        g.num_buffers = g.num_transfers + 1 ;
+    }
+    g.push_samples = clamp( g.push_samples, 1, STREAM_MAX_PUSH_SAMPLES );
+    if( g.timeout_ms == 0 ) {
+        g.timeout_ms = DEFAULT_STREAM_TIMEOUT ;
+    }
+    *geometry = g ;
+}
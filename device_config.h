@@ -0,0 +1,134 @@
+/* =====================================================================================
+ * Adds BladeRF capability to SDRNode
+ * Copyright (C) 2016 Sylvain AZARIAN <sylvain.azarian@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DEVICE_CONFIG_H
+#define DEVICE_CONFIG_H
+
+#include <stdint.h>
+#include "jansson/jansson.h"
+#include "thread_placement.h"
+#include "channelizer.h"
+#include "dc_cal_cache.h"
+#include "tune_cache.h"
+
+/*
+ * Per device settings read once from the init JSON.
+ * Every key can be given at the root level and overridden per serial number :
+ *   { "stream" : { "profile" : "auto", "target_latency_us" : 4000 },
+ *     "devices" : { "<serial>" : { "stream" : { "push_samples" : 16384 } } } }
+ * Overrides are merged key by key, a device object only needs the keys it changes.
+ */
+
+#define DEFAULT_STREAM_XFERS 64
+#define DEFAULT_STREAM_BUFFERS 32
+#define DEFAULT_STREAM_SAMPLES 8192
+#define DEFAULT_STREAM_TIMEOUT 5000
+
+#define DEFAULT_STREAM_BUFFERSIZE 8192*4
+#define DEFAULT_STREAM_NUMTRANSFERS 16
+
+#define DEFAULT_TARGET_LATENCY_US (4000)
+#define DEFAULT_RETUNE_LEAD_US (1000)
+
+// libbladeRF wants buffers holding a multiple of 1024 samples
+#define STREAM_BUFFER_ALIGN (1024)
+#define STREAM_MAX_PUSH_SAMPLES (65536)
+
+#define ALPHA_DC (0.9996)
+
+// devices opened and set up concurrently by initLibrary
+#define DEFAULT_BRINGUP_WORKERS (4)
+
+// acquisition engines
+#define RX_ENGINE_SYNC   (0)  // sync interface, converted in acquisition_thread
+#define RX_ENGINE_STREAM (1)  // bladerf_stream(), conversion done from the USB buffers in the stream callback
+
+// stream geometry profiles
+#define STREAM_PROFILE_FIXED (0) // geometry taken as given
+#define STREAM_PROFILE_AUTO  (1) // geometry derived from the sample rate and target_latency_us, again on each rate change
+
+struct t_stream_geometry {
+    unsigned int num_buffers ;   // buffers allocated by libbladeRF
+    unsigned int buffer_size ;   // IQ samples per USB buffer
+    unsigned int num_transfers ; // USB transfers in flight, less than num_buffers
+    unsigned int timeout_ms ;
+    unsigned int push_samples ;  // IQ samples per block given to the push callback
+};
+
+struct t_device_config {
+    int rx_engine ;
+    int ring_depth ;         // 0 : no receive -> DSP ring
+    int pool_blocks ;
+    bool pool_host_release ; // host calls releaseSamples() for the blocks it keeps
+    double dc_alpha ;
+    bool resampler ;         // advertise decimated rates below the hardware rates
+
+    // offset tuning : the LO sits lo_offset_hz away from the tuned frequency and retunes keeping the
+    // NCO shift between lo_offset_hz/2 and max_offset_hz are done in software, 0 : from the sample rate
+    bool offset_tuning ;
+    int64_t lo_offset_hz ;
+    int64_t max_offset_hz ;
+
+    // quick tune cache, filled at start with the prewarm_hz frequencies. While streaming, a retune to a
+    // cached frequency is scheduled by the FPGA on a block boundary retune_lead_us after the samples
+    // libbladeRF already buffered, unless scheduled_retune is false
+    bool quick_tune ;
+    bool scheduled_retune ;
+    unsigned int retune_lead_us ;
+    int prewarm_count ;
+    unsigned int prewarm_hz[TUNE_CACHE_ENTRIES] ;
+
+    // channelizer, off when channel_count is 0
+    unsigned int channelizer_fft_size ;
+    int channel_count ;
+    double channel_offset_hz[CHANNELIZER_MAX_CHANNELS] ;    // from the tuned frequency
+    double channel_bandwidth_hz[CHANNELIZER_MAX_CHANNELS] ;
+
+    int stream_profile ;
+    unsigned int target_latency_us ;
+    struct t_stream_geometry geometry ; // as configured, see device_config_geometry()
+    // sync engine : on an overrun, libbladeRF waits up to overrun_wait_us for the acquisition thread to
+    // free a buffer before dropping the transfers in flight. 0 : drop at once
+    unsigned int overrun_wait_us ;
+    // sync engine : a blocked read is woken up once wake_batch buffers are ready, and polls for up to
+    // spin_us before blocking. 1 and 0 : woken up for each buffer, no polling
+    unsigned int wake_batch ;
+    unsigned int spin_us ;
+
+    struct t_thread_placement placement ;
+
+    // sync engine : after finalizeRXEngine() keep the RX module enabled and the transfers running,
+    // dropping the samples, for standby_timeout_ms before powering down. 0 : off
+    unsigned int standby_timeout_ms ;
+
+    // LMS DC calibration cache, empty dir : calibrate at each start
+    char dc_cal_dir[DC_CAL_DIR_LEN] ;
+    unsigned int dc_cal_max_age_s ;
+};
+
+// reads the settings of the device with the given serial, root may be NULL
+void device_config_read( json_t *root, const char *serial, int usb_bus, struct t_device_config *cfg );
+
+// worker threads for the device bring-up, root level "bringup_workers" key
+int device_config_bringup_workers( json_t *root );
+
+// geometry to use at sample_rate : the configured one checked against libbladeRF constraints,
+// or the one derived from the target latency for the auto profile
+void device_config_geometry( const struct t_device_config *cfg, unsigned int sample_rate,
+                             struct t_stream_geometry *geometry );
+
+#endif // DEVICE_CONFIG_H
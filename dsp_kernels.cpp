@@ -0,0 +1,440 @@
+/* =====================================================================================
+ * Adds BladeRF capability to SDRNode
+ * Copyright (C) 2016 Sylvain AZARIAN <sylvain.azarian@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <stdint.h>
+#include <sys/types.h>
+#ifndef _WINDOWS
+#include <endian.h>
+#endif
+
+#include "dsp_kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define DSP_HAVE_X86 (1)
+#include <immintrin.h>
+#endif
+
+#define SC16Q11_SCALE (1.0f/2048.0f)
+
+t_convert_dc_fn dsp_convert_dc = convert_dc_scalar ;
+t_fir_dot_fn dsp_fir_dot = fir_dot_scalar ;
+t_mix_fn dsp_mix = mix_scalar ;
+
+/**
+ * @brief convert_dc_scalar reference implementation, the SIMD kernels must match it within float rounding
+ * @param in interleaved I/Q, SC16Q11
+ * @param out
+ * @param count number of IQ samples
+ * @param dc filter state, updated
+ * @param alpha DC blocker pole
+ */
+void convert_dc_scalar( const int16_t *in, TYPECPX *out, int count,
+                        struct t_dc_state *dc, double alpha ) {
+    float I,Q ;
+    TYPECPX tmp;
+
+    for( int i=0 ; i < count ; i++ ) {
+        int j=2*i;
+#ifndef _WINDOWS
+        I = (float)( (int16_t)le16toh( in[ j   ] ))* 1.0/2048.0 ;
+        Q = (float)( (int16_t)le16toh( in[ j+1 ] ))* 1.0/2048.0 ;
+#else
+        I = (float)( in[ j   ]) * 1.0/2048.0 ;
+        Q = (float)( in[ j+1 ]) * 1.0/2048.0 ;
+#endif
+        tmp.re = I - dc->xn_1.re + alpha * dc->yn_1.re ;
+        tmp.im = Q - dc->xn_1.im + alpha * dc->yn_1.im ;
+
+        dc->xn_1.re = I ;
+        dc->xn_1.im = Q ;
+        dc->yn_1 = tmp ;
+
+        out[i] = tmp ;
+    }
+}
+
+void fir_dot_scalar( const float *coeffs, const float *in_i, const float *in_q,
+                     int taps, TYPECPX *out ) {
+    float acc_i = 0 ;
+    float acc_q = 0 ;
+    for( int k=0 ; k < taps ; k++ ) {
+        acc_i += coeffs[k] * in_i[k] ;
+        acc_q += coeffs[k] * in_q[k] ;
+    }
+    out->re = acc_i ;
+    out->im = acc_q ;
+}
+
+// advances the NCO phase by count samples
+static void nco_advance( struct t_nco *nco, int count ) {
+    nco->phase = fmod( nco->phase + count * nco->step, 2*M_PI );
+    if( nco->phase < 0 ) {
+        nco->phase += 2*M_PI ;
+    }
+}
+
+void mix_scalar( TYPECPX *x, int count, struct t_nco *nco ) {
+    for( int start=0 ; start < count ; start += DSP_NCO_RESYNC ) {
+        int n = count - start < DSP_NCO_RESYNC ? count - start : DSP_NCO_RESYNC ;
+        double phase = nco->phase + start * nco->step ;
+        double pr = cos( phase ), pi = sin( phase );
+        const double rr = cos( nco->step ), ri = sin( nco->step );
+        for( int i=start ; i < start + n ; i++ ) {
+            float re = x[i].re ;
+            float im = x[i].im ;
+            x[i].re = (float)(re * pr - im * pi) ;
+            x[i].im = (float)(re * pi + im * pr) ;
+            double t = pr * rr - pi * ri ;
+            pi = pr * ri + pi * rr ;
+            pr = t ;
+        }
+    }
+    nco_advance( nco, count );
+}
+
+#ifdef DSP_HAVE_X86
+
+// The SIMD kernels use the look-ahead form of the DC blocker. With d[n] = x[n] - x[n-1]
+// (exact in float for Q11 inputs), the K outputs of one vector are
+//     y[n+k] = sum_{j<=k} a^(k-j) d[n+j]  +  a^(k+1) y[n-1]
+// The first term is a log2(K) step prefix scan inside the register (shift by 1, 2, 4 complex
+// samples, weighted by a, a^2, a^4), the second one adds the carry from the previous vector
+// weighted by precomputed powers of a. Only the carry propagation stays serial.
+// The scan runs in float while the scalar reference accumulates a*y in double, so outputs
+// differ by a few float ulps of |y| : the state carried to the next push is the last output.
+
+__attribute__((target("sse2")))
+static void convert_dc_sse2( const int16_t *in, TYPECPX *out, int count,
+                             struct t_dc_state *dc, double alpha ) {
+    const float a = (float)alpha ;
+    const __m128 scale = _mm_set1_ps( SC16Q11_SCALE );
+    const __m128 a1 = _mm_set1_ps( a );
+    const __m128 pw = _mm_setr_ps( a, a, a*a, a*a );
+    __m128 carry = _mm_setr_ps( 0, 0, dc->xn_1.re, dc->xn_1.im );
+    __m128 y = _mm_setr_ps( 0, 0, dc->yn_1.re, dc->yn_1.im );
+    float *dst = (float *)out ;
+    int i = 0 ;
+
+    // 4 IQ samples per iteration
+    for( ; i + 4 <= count ; i += 4 ) {
+        __m128i v  = _mm_loadu_si128( (const __m128i *)(in + 2*i) );
+        __m128i lo = _mm_srai_epi32( _mm_unpacklo_epi16( v, v ), 16 );
+        __m128i hi = _mm_srai_epi32( _mm_unpackhi_epi16( v, v ), 16 );
+        __m128 flo = _mm_mul_ps( _mm_cvtepi32_ps( lo ), scale );
+        __m128 fhi = _mm_mul_ps( _mm_cvtepi32_ps( hi ), scale );
+
+        // x[n-1] : shift by one complex sample
+        __m128 dlo = _mm_sub_ps( flo, _mm_shuffle_ps( carry, flo, _MM_SHUFFLE(1,0,3,2) ));
+        __m128 dhi = _mm_sub_ps( fhi, _mm_shuffle_ps( flo, fhi, _MM_SHUFFLE(1,0,3,2) ));
+        carry = fhi ;
+
+        // prefix scan inside each vector
+        dlo = _mm_add_ps( dlo, _mm_mul_ps( a1, _mm_movelh_ps( _mm_setzero_ps(), dlo )));
+        dhi = _mm_add_ps( dhi, _mm_mul_ps( a1, _mm_movelh_ps( _mm_setzero_ps(), dhi )));
+
+        // propagate the carry
+        y = _mm_add_ps( dlo, _mm_mul_ps( pw, _mm_movehl_ps( y, y )));
+        _mm_storeu_ps( dst + 2*i, y );
+        y = _mm_add_ps( dhi, _mm_mul_ps( pw, _mm_movehl_ps( y, y )));
+        _mm_storeu_ps( dst + 2*i + 4, y );
+    }
+
+    float last[4] ;
+    _mm_storeu_ps( last, carry );
+    dc->xn_1.re = last[2] ;
+    dc->xn_1.im = last[3] ;
+    _mm_storeu_ps( last, y );
+    dc->yn_1.re = last[2] ;
+    dc->yn_1.im = last[3] ;
+    if( i < count ) {
+        convert_dc_scalar( in + 2*i, out + i, count - i, dc, alpha );
+    }
+}
+
+__attribute__((target("avx2")))
+static void convert_dc_avx2( const int16_t *in, TYPECPX *out, int count,
+                             struct t_dc_state *dc, double alpha ) {
+    const float a = (float)alpha ;
+    const float a2 = a*a ;
+    const __m256 scale = _mm256_set1_ps( SC16Q11_SCALE );
+    const __m256i rot = _mm256_setr_epi32( 6, 7, 0, 1, 2, 3, 4, 5 );
+    const __m256i last_cpx = _mm256_setr_epi32( 6, 7, 6, 7, 6, 7, 6, 7 );
+    const __m256 a1 = _mm256_set1_ps( a );
+    const __m256 a2v = _mm256_set1_ps( a2 );
+    const __m256 pw = _mm256_setr_ps( a, a, a2, a2, a2*a, a2*a, a2*a2, a2*a2 );
+    __m256 carry = _mm256_setr_ps( 0, 0, 0, 0, 0, 0, dc->xn_1.re, dc->xn_1.im );
+    __m256 y = _mm256_setr_ps( 0, 0, 0, 0, 0, 0, dc->yn_1.re, dc->yn_1.im );
+    float *dst = (float *)out ;
+    int i = 0 ;
+
+    // 8 IQ samples per iteration
+    for( ; i + 8 <= count ; i += 8 ) {
+        __m256i v = _mm256_loadu_si256( (const __m256i *)(in + 2*i) );
+        __m256 flo = _mm256_mul_ps( _mm256_cvtepi32_ps( _mm256_cvtepi16_epi32( _mm256_castsi256_si128( v ))), scale );
+        __m256 fhi = _mm256_mul_ps( _mm256_cvtepi32_ps( _mm256_cvtepi16_epi32( _mm256_extracti128_si256( v, 1 ))), scale );
+
+        __m256 rlo = _mm256_permutevar8x32_ps( flo, rot );
+        __m256 rhi = _mm256_permutevar8x32_ps( fhi, rot );
+        __m256 dlo = _mm256_sub_ps( flo, _mm256_blend_ps( rlo, _mm256_permutevar8x32_ps( carry, rot ), 0x03 ));
+        __m256 dhi = _mm256_sub_ps( fhi, _mm256_blend_ps( rhi, rlo, 0x03 ));
+        carry = fhi ;
+
+        // prefix scan inside each vector : shift by 1 then 2 complex samples
+        dlo = _mm256_add_ps( dlo, _mm256_mul_ps( a1, _mm256_blend_ps( _mm256_permutevar8x32_ps( dlo, rot ), _mm256_setzero_ps(), 0x03 )));
+        dhi = _mm256_add_ps( dhi, _mm256_mul_ps( a1, _mm256_blend_ps( _mm256_permutevar8x32_ps( dhi, rot ), _mm256_setzero_ps(), 0x03 )));
+        dlo = _mm256_add_ps( dlo, _mm256_mul_ps( a2v, _mm256_permute2f128_ps( dlo, dlo, 0x08 )));
+        dhi = _mm256_add_ps( dhi, _mm256_mul_ps( a2v, _mm256_permute2f128_ps( dhi, dhi, 0x08 )));
+
+        // propagate the carry
+        y = _mm256_add_ps( dlo, _mm256_mul_ps( pw, _mm256_permutevar8x32_ps( y, last_cpx )));
+        _mm256_storeu_ps( dst + 2*i, y );
+        y = _mm256_add_ps( dhi, _mm256_mul_ps( pw, _mm256_permutevar8x32_ps( y, last_cpx )));
+        _mm256_storeu_ps( dst + 2*i + 8, y );
+    }
+
+    float last[8] ;
+    _mm256_storeu_ps( last, carry );
+    dc->xn_1.re = last[6] ;
+    dc->xn_1.im = last[7] ;
+    _mm256_storeu_ps( last, y );
+    dc->yn_1.re = last[6] ;
+    dc->yn_1.im = last[7] ;
+    if( i < count ) {
+        convert_dc_scalar( in + 2*i, out + i, count - i, dc, alpha );
+    }
+}
+
+__attribute__((target("avx512f")))
+static void convert_dc_avx512( const int16_t *in, TYPECPX *out, int count,
+                               struct t_dc_state *dc, double alpha ) {
+    const __m512 scale = _mm512_set1_ps( SC16Q11_SCALE );
+    const __m512i rot1 = _mm512_setr_epi32( 14, 15, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13 );
+    const __m512i rot2 = _mm512_setr_epi32( 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 );
+    const __m512i rot4 = _mm512_setr_epi32( 8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7 );
+    const __m512i last_cpx = _mm512_setr_epi32( 14, 15, 14, 15, 14, 15, 14, 15, 14, 15, 14, 15, 14, 15, 14, 15 );
+    float powers[16] ;
+    float p = 1.0f ;
+    for( int k=0 ; k < 8 ; k++ ) {
+        p *= (float)alpha ;
+        powers[2*k] = powers[2*k+1] = p ;
+    }
+    const __m512 a1 = _mm512_set1_ps( powers[0] );
+    const __m512 a2 = _mm512_set1_ps( powers[2] );
+    const __m512 a4 = _mm512_set1_ps( powers[6] );
+    const __m512 pw = _mm512_loadu_ps( powers );
+    __m512 carry = _mm512_setzero_ps();
+    __m512 y = _mm512_setzero_ps();
+    float *dst = (float *)out ;
+    int i = 0 ;
+
+    carry = _mm512_mask_broadcast_f32x4( carry, 0xC000,
+                                         _mm_setr_ps( 0, 0, dc->xn_1.re, dc->xn_1.im ));
+    y = _mm512_mask_broadcast_f32x4( y, 0xC000,
+                                     _mm_setr_ps( 0, 0, dc->yn_1.re, dc->yn_1.im ));
+
+    // 16 IQ samples per iteration
+    for( ; i + 16 <= count ; i += 16 ) {
+        __m256i vlo = _mm256_loadu_si256( (const __m256i *)(in + 2*i) );
+        __m256i vhi = _mm256_loadu_si256( (const __m256i *)(in + 2*i + 16) );
+        __m512 flo = _mm512_mul_ps( _mm512_cvtepi32_ps( _mm512_cvtepi16_epi32( vlo )), scale );
+        __m512 fhi = _mm512_mul_ps( _mm512_cvtepi32_ps( _mm512_cvtepi16_epi32( vhi )), scale );
+
+        __m512 rlo = _mm512_permutexvar_ps( rot1, flo );
+        __m512 rhi = _mm512_permutexvar_ps( rot1, fhi );
+        __m512 dlo = _mm512_sub_ps( flo, _mm512_mask_blend_ps( 0x0003, rlo, _mm512_permutexvar_ps( rot1, carry )));
+        __m512 dhi = _mm512_sub_ps( fhi, _mm512_mask_blend_ps( 0x0003, rhi, rlo ));
+        carry = fhi ;
+
+        // prefix scan inside each vector : shift by 1, 2 then 4 complex samples
+        dlo = _mm512_fmadd_ps( a1, _mm512_maskz_permutexvar_ps( 0xFFFC, rot1, dlo ), dlo );
+        dhi = _mm512_fmadd_ps( a1, _mm512_maskz_permutexvar_ps( 0xFFFC, rot1, dhi ), dhi );
+        dlo = _mm512_fmadd_ps( a2, _mm512_maskz_permutexvar_ps( 0xFFF0, rot2, dlo ), dlo );
+        dhi = _mm512_fmadd_ps( a2, _mm512_maskz_permutexvar_ps( 0xFFF0, rot2, dhi ), dhi );
+        dlo = _mm512_fmadd_ps( a4, _mm512_maskz_permutexvar_ps( 0xFF00, rot4, dlo ), dlo );
+        dhi = _mm512_fmadd_ps( a4, _mm512_maskz_permutexvar_ps( 0xFF00, rot4, dhi ), dhi );
+
+        // propagate the carry
+        y = _mm512_fmadd_ps( pw, _mm512_permutexvar_ps( last_cpx, y ), dlo );
+        _mm512_storeu_ps( dst + 2*i, y );
+        y = _mm512_fmadd_ps( pw, _mm512_permutexvar_ps( last_cpx, y ), dhi );
+        _mm512_storeu_ps( dst + 2*i + 16, y );
+    }
+
+    float last[16] ;
+    _mm512_storeu_ps( last, carry );
+    dc->xn_1.re = last[14] ;
+    dc->xn_1.im = last[15] ;
+    _mm512_storeu_ps( last, y );
+    dc->yn_1.re = last[14] ;
+    dc->yn_1.im = last[15] ;
+    if( i < count ) {
+        convert_dc_scalar( in + 2*i, out + i, count - i, dc, alpha );
+    }
+}
+
+__attribute__((target("sse2")))
+static void fir_dot_sse2( const float *coeffs, const float *in_i, const float *in_q,
+                          int taps, TYPECPX *out ) {
+    __m128 acc_i = _mm_setzero_ps();
+    __m128 acc_q = _mm_setzero_ps();
+    for( int k=0 ; k < taps ; k += 4 ) {
+        __m128 c = _mm_loadu_ps( coeffs + k );
+        acc_i = _mm_add_ps( acc_i, _mm_mul_ps( c, _mm_loadu_ps( in_i + k )));
+        acc_q = _mm_add_ps( acc_q, _mm_mul_ps( c, _mm_loadu_ps( in_q + k )));
+    }
+    // horizontal sums, I in the low half, Q in the high half
+    __m128 s = _mm_add_ps( _mm_unpacklo_ps( acc_i, acc_q ), _mm_unpackhi_ps( acc_i, acc_q ));
+    s = _mm_add_ps( s, _mm_movehl_ps( s, s ));
+    out->re = _mm_cvtss_f32( s );
+    out->im = _mm_cvtss_f32( _mm_shuffle_ps( s, s, _MM_SHUFFLE(1,1,1,1) ));
+}
+
+__attribute__((target("avx2,fma")))
+static void fir_dot_avx2( const float *coeffs, const float *in_i, const float *in_q,
+                          int taps, TYPECPX *out ) {
+    __m256 acc_i = _mm256_setzero_ps();
+    __m256 acc_q = _mm256_setzero_ps();
+    for( int k=0 ; k < taps ; k += 8 ) {
+        __m256 c = _mm256_loadu_ps( coeffs + k );
+        acc_i = _mm256_fmadd_ps( c, _mm256_loadu_ps( in_i + k ), acc_i );
+        acc_q = _mm256_fmadd_ps( c, _mm256_loadu_ps( in_q + k ), acc_q );
+    }
+    __m256 s8 = _mm256_add_ps( _mm256_unpacklo_ps( acc_i, acc_q ), _mm256_unpackhi_ps( acc_i, acc_q ));
+    __m128 s = _mm_add_ps( _mm256_castps256_ps128( s8 ), _mm256_extractf128_ps( s8, 1 ));
+    s = _mm_add_ps( s, _mm_movehl_ps( s, s ));
+    out->re = _mm_cvtss_f32( s );
+    out->im = _mm_cvtss_f32( _mm_shuffle_ps( s, s, _MM_SHUFFLE(1,1,1,1) ));
+}
+
+__attribute__((target("avx512f")))
+static void fir_dot_avx512( const float *coeffs, const float *in_i, const float *in_q,
+                            int taps, TYPECPX *out ) {
+    __m512 acc_i = _mm512_setzero_ps();
+    __m512 acc_q = _mm512_setzero_ps();
+    for( int k=0 ; k < taps ; k += 16 ) {
+        __m512 c = _mm512_loadu_ps( coeffs + k );
+        acc_i = _mm512_fmadd_ps( c, _mm512_loadu_ps( in_i + k ), acc_i );
+        acc_q = _mm512_fmadd_ps( c, _mm512_loadu_ps( in_q + k ), acc_q );
+    }
+    out->re = _mm512_reduce_add_ps( acc_i );
+    out->im = _mm512_reduce_add_ps( acc_q );
+}
+
+// fills lanes phasors exp(i.(phase + k.step)), k < lanes, and returns exp(i.lanes.step)
+static void nco_lanes( double phase, double step, int lanes, float *phasors, float *rotation ) {
+    for( int k=0 ; k < lanes ; k++ ) {
+        phasors[2*k]   = (float)cos( phase + k*step );
+        phasors[2*k+1] = (float)sin( phase + k*step );
+    }
+    rotation[0] = (float)cos( lanes*step );
+    rotation[1] = (float)sin( lanes*step );
+}
+
+// complex products on interleaved re/im : [ar*br - ai*bi, ai*br + ar*bi]
+__attribute__((target("sse3")))
+static inline __m128 cmul_sse3( __m128 a, __m128 b ) {
+    __m128 a_swap = _mm_shuffle_ps( a, a, _MM_SHUFFLE(2,3,0,1) );
+    return( _mm_addsub_ps( _mm_mul_ps( a, _mm_moveldup_ps( b )), _mm_mul_ps( a_swap, _mm_movehdup_ps( b ))));
+}
+
+__attribute__((target("sse3")))
+static void mix_sse3( TYPECPX *x, int count, struct t_nco *nco ) {
+    float *data = (float *)x ;
+    float lanes[4], rot[2] ;
+    int i = 0 ;
+
+    for( ; i + 2 <= count ; ) {
+        int end = i + DSP_NCO_RESYNC < count ? i + DSP_NCO_RESYNC : count ;
+        nco_lanes( nco->phase + i * nco->step, nco->step, 2, lanes, rot );
+        __m128 p = _mm_loadu_ps( lanes );
+        const __m128 r = _mm_setr_ps( rot[0], rot[1], rot[0], rot[1] );
+        for( ; i + 2 <= end ; i += 2 ) {
+            _mm_storeu_ps( data + 2*i, cmul_sse3( _mm_loadu_ps( data + 2*i ), p ));
+            p = cmul_sse3( p, r );
+        }
+    }
+    if( i < count ) {
+        struct t_nco tail = { nco->phase + i * nco->step, nco->step };
+        mix_scalar( x + i, count - i, &tail );
+    }
+    nco_advance( nco, count );
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256 cmul_avx2( __m256 a, __m256 b ) {
+    __m256 a_swap = _mm256_permute_ps( a, _MM_SHUFFLE(2,3,0,1) );
+    return( _mm256_fmaddsub_ps( a, _mm256_moveldup_ps( b ), _mm256_mul_ps( a_swap, _mm256_movehdup_ps( b ))));
+}
+
+__attribute__((target("avx2,fma")))
+static void mix_avx2( TYPECPX *x, int count, struct t_nco *nco ) {
+    float *data = (float *)x ;
+    float lanes[8], rot[2] ;
+    int i = 0 ;
+
+    for( ; i + 4 <= count ; ) {
+        int end = i + DSP_NCO_RESYNC < count ? i + DSP_NCO_RESYNC : count ;
+        nco_lanes( nco->phase + i * nco->step, nco->step, 4, lanes, rot );
+        __m256 p = _mm256_loadu_ps( lanes );
+        const __m256 r = _mm256_setr_ps( rot[0], rot[1], rot[0], rot[1], rot[0], rot[1], rot[0], rot[1] );
+        for( ; i + 4 <= end ; i += 4 ) {
+            _mm256_storeu_ps( data + 2*i, cmul_avx2( _mm256_loadu_ps( data + 2*i ), p ));
+            p = cmul_avx2( p, r );
+        }
+    }
+    if( i < count ) {
+        struct t_nco tail = { nco->phase + i * nco->step, nco->step };
+        mix_scalar( x + i, count - i, &tail );
+    }
+    nco_advance( nco, count );
+}
+#endif
+
+/**
+ * @brief dsp_kernels_init selects the conversion and FIR kernels from the CPU features (cpuid)
+ * @return the name of the selected instruction set
+ */
+const char *dsp_kernels_init() {
+#ifdef DSP_HAVE_X86
+    __builtin_cpu_init();
+    if( __builtin_cpu_supports("avx512f")) {
+        dsp_convert_dc = convert_dc_avx512 ;
+        dsp_fir_dot = fir_dot_avx512 ;
+        dsp_mix = mix_avx2 ;
+        return("avx512");
+    }
+    if( __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        dsp_convert_dc = convert_dc_avx2 ;
+        dsp_fir_dot = fir_dot_avx2 ;
+        dsp_mix = mix_avx2 ;
+        return("avx2");
+    }
+    if( __builtin_cpu_supports("sse2")) {
+        dsp_convert_dc = convert_dc_sse2 ;
+        dsp_fir_dot = fir_dot_sse2 ;
+        dsp_mix = __builtin_cpu_supports("sse3") ? mix_sse3 : mix_scalar ;
+        return("sse2");
+    }
+#endif
+    dsp_convert_dc = convert_dc_scalar ;
+    dsp_fir_dot = fir_dot_scalar ;
+    dsp_mix = mix_scalar ;
+    return("scalar");
+}
@@ -0,0 +1,79 @@
+/* =====================================================================================
+ * Adds BladeRF capability to SDRNode
+ * Copyright (C) 2016 Sylvain AZARIAN <sylvain.azarian@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DSP_KERNELS_H
+#define DSP_KERNELS_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+typedef struct __attribute__ ((__packed__)) _sCplx
+{
+    float re;
+    float im;
+} TYPECPX;
+
+// DC blocker state, y[n] = x[n] - x[n-1] + alpha * y[n-1]
+// see http://peabody.sapp.org/class/dmp2/lab/dcblock/
+struct t_dc_state {
+    TYPECPX xn_1 ;
+    TYPECPX yn_1 ;
+};
+
+// converts count SC16Q11 IQ samples to float and removes DC, in one pass
+typedef void (*t_convert_dc_fn)( const int16_t *in, TYPECPX *out, int count,
+                                 struct t_dc_state *dc, double alpha );
+
+// kernel selected at runtime by dsp_kernels_init()
+extern t_convert_dc_fn dsp_convert_dc ;
+
+// scalar reference, always available
+void convert_dc_scalar( const int16_t *in, TYPECPX *out, int count,
+                        struct t_dc_state *dc, double alpha );
+
+// FIR dot product on split I/Q : out = sum coeffs[k] * (in_i[k], in_q[k]), taps is a multiple of
+// DSP_FIR_TAP_ALIGN. Used by the polyphase resampler, coefficients are real.
+#define DSP_FIR_TAP_ALIGN (16)
+
+typedef void (*t_fir_dot_fn)( const float *coeffs, const float *in_i, const float *in_q,
+                              int taps, TYPECPX *out );
+
+extern t_fir_dot_fn dsp_fir_dot ;
+
+void fir_dot_scalar( const float *coeffs, const float *in_i, const float *in_q,
+                     int taps, TYPECPX *out );
+
+// numerically controlled oscillator, x[n] *= exp(i.(phase + n.step))
+// phase is kept in double and the SIMD kernels restart their float phasors from it every
+// DSP_NCO_RESYNC samples, so amplitude and phase do not drift
+#define DSP_NCO_RESYNC (1024)
+
+struct t_nco {
+    double phase ; // radians, in [0, 2.pi[
+    double step ;  // radians per sample
+};
+
+typedef void (*t_mix_fn)( TYPECPX *x, int count, struct t_nco *nco );
+
+extern t_mix_fn dsp_mix ;
+
+void mix_scalar( TYPECPX *x, int count, struct t_nco *nco );
+
+// pick the best kernels for this CPU, returns their name ("scalar", "sse2", "avx2", "avx512")
+const char *dsp_kernels_init();
+
+#endif // DSP_KERNELS_H
@@ -30,16 +30,23 @@
 #include "jansson/jansson.h"
 
 #include "entrypoint.h"
+#include "sample_pool.h"
+#include "dsp_kernels.h"
+#include "stream_ring.h"
+#include "thread_placement.h"
+#include "device_config.h"
+#include "resampler.h"
+#include "channelizer.h"
+#include "dc_cal_cache.h"
+#include "rx_stats.h"
+#include "control_queue.h"
+#include "tune_cache.h"
+#include "sweep.h"
 #define DEBUG_DRIVER (1)
 
 char *driver_name ;
 void* acquisition_thread( void *params ) ;
-
-typedef struct __attribute__ ((__packed__)) _sCplx
-{
-    float re;
-    float im;
-} TYPECPX;
+void* dsp_thread( void *params ) ;
 
 
 unsigned int lms_filters[] = { 1500000u, 1750000u, 2500000u, 2750000u, 3000000u,
@@ -48,6 +55,27 @@ unsigned int lms_filters[] = { 1500000u, 1750000u, 2500000u, 2750000u, 3000000u,
                            20000000u };
 #define FILTER_TAB_LENGTH (16)
 
+#define METADATA_HEADER_SIZE (16)
+
+// rates below the hardware ones, produced by the polyphase resampler from hw_rate
+struct t_decimated_rate {
+    unsigned int rate ;
+    unsigned int hw_rate ;
+    unsigned int interp ;
+    unsigned int decim ;
+};
+
+struct t_decimated_rate decimated_rates[] = {
+    { 1024000u, 2048000u,   1,    2 },
+    { 1000000u, 2048000u, 125,  256 },
+    {  512000u, 2048000u,   1,    4 },
+    {  500000u, 2048000u, 125,  512 },
+    {  256000u, 2048000u,   1,    8 },
+    {  250000u, 2048000u, 125, 1024 },
+    {  128000u, 2048000u,   1,   16 }
+};
+#define DECIMATED_RATES_COUNT (7)
+
 
 struct t_sample_rates {
     unsigned int *sample_rates ;
@@ -58,6 +86,13 @@ struct t_sample_rates {
 
 #define STAGES_COUNT (3)
 
+// device bring-up stages, timed by bringupDevice()
+#define BRINGUP_OPEN    (0)
+#define BRINGUP_FPGA    (1)
+#define BRINGUP_FILTERS (2)
+#define BRINGUP_SETUP   (3)
+#define BRINGUP_STAGES  (4)
+
 // this structure stores the device state
 struct t_rx_device {
     bladerf *bladerf_device ;
@@ -65,11 +100,13 @@ struct t_rx_device {
     char *device_serial_number ;
 
     struct t_sample_rates* rates;
-    unsigned int current_sample_rate ;
+    unsigned int current_sample_rate ; // hardware rate
+    unsigned int output_sample_rate ;  // rate pushed to SDRNode, lower when decimating
 
     int64_t min_frq_hz ; // minimal frequency for this device
     int64_t max_frq_hz ; // maximal frequency for this device
     int64_t center_frq_hz ; // currently set frequency
+    int64_t lo_frq_hz ;     // LMS LO, differs from center_frq_hz in offset tuning mode
 
 
     float gain[STAGES_COUNT] ;
@@ -80,11 +117,92 @@ struct t_rx_device {
     sem_t mutex;
 
     pthread_t receive_thread ;
-    struct ext_Context ext_context ;
+    struct ext_Context ext_context ; // filled by the thread pushing the samples, for each block
+    uint64_t push_next_timestamp ;   // expected timestamp of the next block, in hardware ticks
+
+    // preallocated blocks passed to the push callback
+    struct t_sample_pool *pool ;
+
+    // settings from the init JSON, and the stream geometry derived from them
+    struct t_device_config config ;
+    struct t_stream_geometry geometry ;     // in use by the acquisition path
+    struct t_stream_geometry requested_geometry ; // chosen for the current rate, guarded by geometry_lock
+    pthread_mutex_t geometry_lock ;
+    volatile unsigned int geometry_serial ; // bumped when requested_geometry changes
+    unsigned int geometry_applied ;         // last serial taken by the acquisition path
+    struct t_stream_geometry stream_geometry ; // geometry the libbladeRF stream was created with
+
+    // acquisition engine
+    struct bladerf_stream *stream ;
+    void **stream_buffers ;
+    unsigned int msg_size ;   // USB message size in stream mode, header included
+    TYPECPX *cur_block ;      // block being filled by the stream callback
+    unsigned int cur_fill ;
+    uint64_t cur_timestamp ;  // timestamp of the first sample of cur_block
+
+    // receive -> DSP pipeline, NULL when conversion and push are done by the receiving thread
+    struct t_stream_ring *ring ;
+    struct t_ring_slot *cur_slot ; // slot being filled by the stream callback
+    pthread_t process_thread ;
+
+    // decimation before the push : the ratio is requested by setRxSampleRate as interp << 32 | decim
+    // (0 for none) and the resampler is rebuilt by the thread pushing the samples
+    volatile uint64_t resampler_request ;
+    uint64_t resampler_ratio ;
+    struct t_resampler *resampler ;
+
+    // offset tuning : shift requested by tuneRx, NCO owned by the thread pushing the samples
+    volatile int64_t nco_request_hz ; // center_frq_hz - lo_frq_hz
+    int64_t nco_shift_hz ;
+    unsigned int nco_rate ;
+    struct t_nco nco ;
+    uint64_t lo_retunes ;
+    uint64_t nco_retunes ;
+
+    // quick tune values of the frequencies already visited, see moveLo(). A scheduled hop happens at
+    // hop_timestamp, the blocks before it are still at hop_from_hz
+    struct t_tune_cache tune_cache ;
+    volatile uint64_t hop_timestamp ;
+    volatile int64_t hop_from_hz ;
+    uint64_t quick_retunes ;
+    uint64_t scheduled_retunes ;
+
+    // sweep mode : plans from startSweep() are handed to the acquisition thread like the geometry
+    pthread_mutex_t sweep_lock ;
+    struct t_sweep *sweep_request ;     // guarded by sweep_lock, NULL : stop sweeping
+    volatile unsigned int sweep_serial ; // bumped when sweep_request changes
+    unsigned int sweep_applied ;
+    struct t_sweep *sweep ;             // owned by the acquisition thread
+    TYPECPX *sweep_block ;              // dwell being filled
+    struct t_dc_state sweep_dc ;        // DC blocker of the dwell being filled, cleared at its first sample
+    struct ext_Context sweep_context ;
+
+    // channelizer, rebuilt by the thread pushing the samples when the hardware rate changes
+    struct t_channelizer *channelizer ;
+    unsigned int channelizer_rate ;
+    uint64_t channelizer_base ;         // timestamp of the channelizer input sample 0, 0 if unknown
 
     // for DC removal
-    TYPECPX xn_1 ;
-    TYPECPX yn_1 ;
+    struct t_dc_state dc ;
+
+    // sync engine without pipeline : blocks are converted in place from the buffer lent by
+    // bladerf_sync_rx_acquire(), see readLent()
+    struct bladerf_sync_rx_buffer lent ; // data NULL : none
+    unsigned int lent_msg ;              // next message to convert
+    unsigned int lent_off ;              // samples of it already converted
+
+    // frequency, gain and rate changes from the SDRNode threads, applied by applyControl()
+    struct t_control_queue control ;
+    volatile int control_busy ;          // 1 while a thread is applying commands
+    volatile unsigned int control_serial ; // bumped after each batch of commands applied
+    unsigned int control_seen ;          // last serial seen by the thread pushing the samples
+
+    // streaming counters, see getStreamStats()
+    struct t_rx_stats stats ;
+    uint64_t warm_starts ; // prepareRXEngine() calls resumed from standby
+
+    // time spent in each initLibrary stage
+    double bringup_ms[BRINGUP_STAGES] ;
 
 
 };
@@ -101,6 +219,7 @@ _pushSamplesFun *acqCbFunction ;
 
 
 int setBladeRxGain( struct t_rx_device *dev, float value, int stage);
+static int applySampleRate( struct t_rx_device *dev, int sample_rate );
 
 #ifdef _WIN64
 #include <windows.h>
@@ -118,7 +237,580 @@ void log( int device_id, int level, char *msg ) {
     printf("Trace:%s\n", msg );
 }
 
+/**
+ * @brief applyPlacement places the calling thread and reports it through the SDRNode log
+ */
+static void applyPlacement( struct t_rx_device *dev, int which ) {
+    char msg[256] ;
+    placement_apply_self( &dev->config.placement, which, msg, sizeof(msg));
+    log( (int)(dev - rx), 0, msg );
+}
+
+/**
+ * @brief requestGeometry derives the stream geometry for the current sample rate and hands it
+ *        to the acquisition path, which switches at the next block boundary
+ * @param dev
+ */
+static void requestGeometry( struct t_rx_device *dev ) {
+    struct t_stream_geometry g ;
+
+    device_config_geometry( &dev->config, dev->current_sample_rate, &g );
+    if( dev->pool != NULL && g.push_samples > dev->pool->block_samples ) {
+        g.push_samples = dev->pool->block_samples ;
+    }
+    pthread_mutex_lock( &dev->geometry_lock );
+    dev->requested_geometry = g ;
+    __atomic_store_n( &dev->geometry_serial, dev->geometry_serial + 1, __ATOMIC_RELEASE );
+    pthread_mutex_unlock( &dev->geometry_lock );
+
+    char msg[256] ;
+    snprintf( msg, sizeof(msg), "stream geometry for %u Hz: push_samples=%u buffer_size=%u buffers=%u transfers=%u",
+              dev->current_sample_rate, g.push_samples, g.buffer_size, g.num_buffers, g.num_transfers );
+    log( (int)(dev - rx), 0, msg );
+}
+
+/**
+ * @brief takeGeometry called by the acquisition path, copies the requested geometry into g if it changed
+ * @return true if there is a new geometry
+ */
+static bool takeGeometry( struct t_rx_device *dev, struct t_stream_geometry *g ) {
+    if( __atomic_load_n( &dev->geometry_serial, __ATOMIC_ACQUIRE ) == dev->geometry_applied ) {
+        return( false );
+    }
+    pthread_mutex_lock( &dev->geometry_lock );
+    *g = dev->requested_geometry ;
+    dev->geometry_applied = dev->geometry_serial ;
+    pthread_mutex_unlock( &dev->geometry_lock );
+    return( true );
+}
+
+/**
+ * @brief hopTimestamp first push block boundary the device has not sampled yet : after the samples
+ *        libbladeRF buffered, plus retune_lead_us for the command to reach the FPGA
+ * @param dev
+ * @return BLADERF_RETUNE_NOW when the stream position is unknown
+ */
+static uint64_t hopTimestamp( struct t_rx_device *dev ) {
+    uint64_t received = __atomic_load_n( &dev->stats.next_timestamp, __ATOMIC_RELAXED );
+    uint64_t pushed = __atomic_load_n( &dev->push_next_timestamp, __ATOMIC_RELAXED );
+    uint64_t block = dev->geometry.push_samples ;
+
+    if( !__atomic_load_n( &dev->running, __ATOMIC_SEQ_CST ) || received == 0 || pushed == 0 || block == 0 ) {
+        return( BLADERF_RETUNE_NOW );
+    }
+    uint64_t target = received + (uint64_t)dev->geometry.num_buffers * dev->geometry.buffer_size +
+            (uint64_t)dev->current_sample_rate * dev->config.retune_lead_us / 1000000 ;
+    if( target < pushed ) {
+        target = pushed ;
+    }
+    // blocks are pushed back to back from pushed on
+    return( pushed + (target - pushed + block - 1) / block * block );
+}
+
+/**
+ * @brief moveLo tunes the LMS LO. With the quick tune cache, a cached frequency skips the VCO search and,
+ *        when scheduled, the FPGA hops on the block boundary given by hopTimestamp(). Other frequencies
+ *        take a blocking full tune, whose result is cached. A hop scheduled while another one is still
+ *        ahead of the stream replaces it at the same timestamp
+ * @param dev
+ * @param lo_hz
+ * @param schedule false to retune at once
+ * @return 0 or a libbladeRF error
+ */
+static int moveLo( struct t_rx_device *dev, int64_t lo_hz, bool schedule ) {
+    struct bladerf_quick_tune values ;
+    unsigned int frequency = (unsigned int)lo_hz ;
+    uint64_t pending = __atomic_load_n( &dev->hop_timestamp, __ATOMIC_RELAXED );
+    int rc ;
+
+    if( pending != 0 && pending <= __atomic_load_n( &dev->stats.next_timestamp, __ATOMIC_RELAXED )) {
+        pending = 0 ; // done, the stream is past it
+    }
+    if( dev->config.quick_tune && tune_cache_find( &dev->tune_cache, frequency, &values )) {
+        uint64_t when = BLADERF_RETUNE_NOW ;
+        if( schedule && dev->config.scheduled_retune ) {
+            when = pending != 0 ? pending : hopTimestamp( dev );
+        }
+        if( pending != 0 ) {
+            bladerf_cancel_scheduled_retunes( dev->bladerf_device, BLADERF_MODULE_RX );
+        }
+        rc = bladerf_schedule_retune( dev->bladerf_device, BLADERF_MODULE_RX, when, frequency, &values );
+        if( rc == 0 ) {
+            if( when == BLADERF_RETUNE_NOW ) {
+                __atomic_store_n( &dev->hop_timestamp, 0, __ATOMIC_RELEASE );
+            } else if( pending == 0 ) {
+                __atomic_store_n( &dev->hop_from_hz, __atomic_load_n( &dev->center_frq_hz, __ATOMIC_RELAXED ), __ATOMIC_RELAXED );
+                __atomic_store_n( &dev->hop_timestamp, when, __ATOMIC_RELEASE );
+                dev->scheduled_retunes++ ;
+            }
+            dev->quick_retunes++ ;
+            return( 0 );
+        }
+        fprintf( stderr, "%s bladerf_schedule_retune failed: %s\n", __func__, bladerf_strerror(rc));
+        pending = 0 ; // cancelled above
+    }
+    if( pending != 0 ) {
+        bladerf_cancel_scheduled_retunes( dev->bladerf_device, BLADERF_MODULE_RX );
+    }
+    __atomic_store_n( &dev->hop_timestamp, 0, __ATOMIC_RELEASE );
+    rc = bladerf_set_frequency( dev->bladerf_device, BLADERF_MODULE_RX, frequency );
+    if( rc != 0 ) {
+        return( rc );
+    }
+    if( dev->config.quick_tune && bladerf_get_quick_tune( dev->bladerf_device, BLADERF_MODULE_RX, &values ) == 0 ) {
+        tune_cache_store( &dev->tune_cache, frequency, &values );
+    }
+    return( 0 );
+}
+
+/**
+ * @brief prewarmTuneCache tunes once to each prewarm_hz frequency to cache its quick tune values
+ * @param dev
+ */
+static void prewarmTuneCache( struct t_rx_device *dev ) {
+    struct bladerf_quick_tune values ;
+    for( int i=0 ; i < dev->config.prewarm_count ; i++ ) {
+        unsigned int frequency = dev->config.prewarm_hz[i] ;
+        if( frequency < dev->min_frq_hz || frequency > dev->max_frq_hz ) {
+            continue ;
+        }
+        if( bladerf_set_frequency( dev->bladerf_device, BLADERF_MODULE_RX, frequency ) == 0 &&
+                bladerf_get_quick_tune( dev->bladerf_device, BLADERF_MODULE_RX, &values ) == 0 ) {
+            tune_cache_store( &dev->tune_cache, frequency, &values );
+        }
+    }
+}
+
+/**
+ * @brief tuneRx tunes the receiver to frq_hz. In offset tuning mode the LO is only moved when the NCO
+ *        cannot reach frq_hz with the LO leakage kept off centre, otherwise only the NCO shift changes
+ *        and there is no USB traffic
+ * @param dev
+ * @param frq_hz
+ * @return 0 or a libbladeRF error code
+ */
+static int tuneRx( struct t_rx_device *dev, int64_t frq_hz ) {
+    int rc ;
+
+    if( !dev->config.offset_tuning ) {
+        rc = moveLo( dev, frq_hz, true );
+        if( rc != 0 ) {
+            return( rc );
+        }
+        dev->lo_frq_hz = frq_hz ;
+    } else {
+        int64_t lo_offset = dev->config.lo_offset_hz > 0 ? dev->config.lo_offset_hz : dev->current_sample_rate / 8 ;
+        int64_t max_offset = dev->config.max_offset_hz > 0 ? dev->config.max_offset_hz : 3 * (int64_t)dev->current_sample_rate / 8 ;
+        int64_t shift = frq_hz - dev->lo_frq_hz ;
+        int64_t distance = shift < 0 ? -shift : shift ;
+
+        if( distance >= lo_offset / 2 && distance <= max_offset ) {
+            dev->nco_retunes++ ;
+        } else {
+            int64_t lo = frq_hz + lo_offset ;
+            if( lo > dev->max_frq_hz ) {
+                lo = frq_hz - lo_offset ;
+            }
+            rc = moveLo( dev, lo, false ); // the NCO shift changes at once, so must the LO
+            if( rc != 0 ) {
+                return( rc );
+            }
+            dev->lo_frq_hz = lo ;
+            dev->lo_retunes++ ;
+        }
+        __atomic_store_n( &dev->nco_request_hz, frq_hz - dev->lo_frq_hz, __ATOMIC_RELEASE );
+    }
+    __atomic_store_n( &dev->center_frq_hz, frq_hz, __ATOMIC_RELEASE );
+    return( 0 );
+}
+
+/**
+ * @brief applyControl applies the queued commands, unless another thread is already doing it.
+ *        Commands are coalesced : only the last rate, the last frequency and the last gain of each
+ *        stage are applied, in that order since the offset tuning range depends on the rate
+ * @param dev
+ * @return number of commands taken from the queue
+ */
+static int applyControl( struct t_rx_device *dev ) {
+    int taken = 0 ;
+
+    for( ;; ) {
+        int idle = 0 ;
+        if( !__atomic_compare_exchange_n( &dev->control_busy, &idle, 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED )) {
+            return( taken ); // the thread applying commands will also see ours
+        }
+        struct t_control_cmd cmd ;
+        struct t_control_cmd rate, frequency, gain[STAGES_COUNT] ;
+        int n = 0 ;
+
+        memset( &rate, 0, sizeof(rate));
+        memset( &frequency, 0, sizeof(frequency));
+        memset( gain, 0, sizeof(gain));
+        rate.type = frequency.type = -1 ;
+        for( int g=0 ; g < STAGES_COUNT ; g++ ) {
+            gain[g].type = -1 ;
+        }
+        while( control_queue_pop( &dev->control, &cmd )) {
+            switch( cmd.type ) {
+            case CONTROL_SET_SAMPLE_RATE : rate = cmd ; break ;
+            case CONTROL_SET_FREQUENCY : frequency = cmd ; break ;
+            case CONTROL_SET_GAIN :
+                if( cmd.stage >= 0 && cmd.stage < STAGES_COUNT ) {
+                    gain[cmd.stage] = cmd ;
+                }
+                break ;
+            }
+            n++ ;
+        }
+        if( rate.type >= 0 ) {
+            applySampleRate( dev, (int)rate.value );
+        }
+        if( frequency.type >= 0 && dev->sweep != NULL ) {
+            // the sweep owns the LO, tuneRx is done when it stops
+            __atomic_store_n( &dev->center_frq_hz, frequency.value, __ATOMIC_RELEASE );
+        } else if( frequency.type >= 0 && tuneRx( dev, frequency.value ) != 0 ) {
+            fprintf( stderr, "%s cannot tune to %ld\n", __func__, (long)frequency.value );
+        }
+        for( int g=0 ; g < STAGES_COUNT ; g++ ) {
+            if( gain[g].type >= 0 ) {
+                setBladeRxGain( dev, gain[g].gain, g );
+            }
+        }
+        if( n > 0 ) {
+            __atomic_add_fetch( &dev->control_serial, 1, __ATOMIC_RELEASE );
+        }
+        taken += n ;
+        __atomic_store_n( &dev->control_busy, 0, __ATOMIC_SEQ_CST );
+
+        // a command pushed while we held the flag saw it busy and left it to us
+        if( control_queue_empty( &dev->control )) {
+            return( taken );
+        }
+    }
+}
+
+/**
+ * @brief submitControl queues a command for the device. While the sync engine streams, the acquisition
+ *        thread applies it between two reads. Otherwise (stopped device, or stream engine, which has no
+ *        read boundary in the driver) the calling thread applies it right away
+ * @param dev
+ * @param cmd
+ * @return RC_OK, RC_NOK if the queue is full
+ */
+static int submitControl( struct t_rx_device *dev, const struct t_control_cmd *cmd ) {
+    if( !control_queue_push( &dev->control, cmd )) {
+        fprintf( stderr, "%s control queue full, command %d dropped\n", __func__, cmd->type );
+        return(RC_NOK);
+    }
+    if( !__atomic_load_n( &dev->running, __ATOMIC_SEQ_CST ) || dev->config.rx_engine == RX_ENGINE_STREAM ) {
+        applyControl( dev );
+    }
+    return(RC_OK);
+}
+
+/**
+ * @brief planFilter picks the LMS low pass filter for a hardware rate without any device access : the
+ *        widest filter with a bandwidth below half the rate, the narrowest one when none is
+ * @param rate
+ * @return filter bandwidth as reported by bladerf_set_bandwidth()
+ */
+static unsigned int planFilter( unsigned int rate ) {
+    for( int x=FILTER_TAB_LENGTH-1 ; x > 0 ; x-- ) {
+        if( lms_filters[x]*2 < rate ) {
+            return( lms_filters[x] );
+        }
+    }
+    return( lms_filters[0] );
+}
+
+/**
+ * @brief outputRate rate of the pushed samples for a hardware rate, lower with the channelizer
+ */
+static unsigned int outputRate( struct t_rx_device *dev, unsigned int hw_rate ) {
+    if( dev->config.channel_count > 0 ) {
+        unsigned int decim = channelizer_decimation( dev->config.channelizer_fft_size, hw_rate,
+                                                     dev->config.channel_bandwidth_hz, dev->config.channel_count );
+        if( decim > 0 ) {
+            return( hw_rate / decim );
+        }
+    }
+    return( hw_rate );
+}
+
+// true if going from a to b needs the USB side (sync interface or stream) to be configured again
+static bool usbGeometryChanged( const struct t_stream_geometry *a, const struct t_stream_geometry *b ) {
+    return( a->num_buffers != b->num_buffers || a->buffer_size != b->buffer_size ||
+            a->num_transfers != b->num_transfers || a->timeout_ms != b->timeout_ms );
+}
+
+/**
+ * @brief elapsedMs milliseconds since t0
+ */
+static double elapsedMs( const struct timespec *t0 ) {
+    struct timespec now ;
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return( (now.tv_sec - t0->tv_sec) * 1e3 + (now.tv_nsec - t0->tv_nsec) / 1e6 );
+}
+
+/**
+ * @brief releaseDevice frees what bringupDevice allocated for a device that could not be set up
+ * @param dev
+ */
+static void releaseDevice( struct t_rx_device *dev ) {
+    if( dev->bladerf_device != NULL ) {
+        bladerf_close( dev->bladerf_device );
+        dev->bladerf_device = NULL ;
+    }
+    if( dev->rates != NULL ) {
+        free( dev->rates->sample_rates );
+        free( dev->rates->rf_filter_bw );
+        free( dev->rates );
+        dev->rates = NULL ;
+    }
+    stream_ring_destroy( dev->ring );
+    dev->ring = NULL ;
+    sample_pool_destroy( dev->pool );
+    dev->pool = NULL ;
+    free( dev->device_serial_number );
+    dev->device_serial_number = NULL ;
+    free( dev->device_name );
+    dev->device_name = NULL ;
+}
+
+/**
+ * @brief bringupDevice opens one board and sets it up, runs on a bring-up worker. Threads, semaphore
+ *        and mutex are left to startDevice() so the structure can still be moved
+ * @param dev
+ * @param devinfo
+ * @return 0, or a libbladeRF error code with the device released
+ */
+static int bringupDevice( struct t_rx_device *dev, struct bladerf_devinfo *devinfo ) {
+    struct timespec t0 ;
+    int rc ;
+
+    memset( dev, 0, sizeof(struct t_rx_device));
+    dev->device_name = (char *)malloc( 64 *sizeof(char));
+    sprintf( dev->device_name, "BladeRF");
+    clock_gettime( CLOCK_MONOTONIC, &t0 );
+    rc = bladerf_open_with_devinfo( &dev->bladerf_device, devinfo );
+    if( rc != 0 ) {
+        fprintf( stderr, "%s : cannot open %s, %s\n", __func__, devinfo->serial, bladerf_strerror(rc));
+        releaseDevice( dev );
+        return( rc );
+    }
+    dev->bringup_ms[BRINGUP_OPEN] = elapsedMs( &t0 );
+    clock_gettime( CLOCK_MONOTONIC, &t0 );
+    if( !bladerf_is_fpga_configured( dev->bladerf_device )) {
+        bladerf_fpga_size size = BLADERF_FPGA_UNKNOWN;
+        rc = bladerf_get_fpga_size( dev->bladerf_device, &size);
+        if (!rc && (size == BLADERF_FPGA_UNKNOWN)) {
+            size = BLADERF_FPGA_40KLE;
+        }
+        if( !rc ) {
+            char fpgaFile[255];
+            switch (size)
+            {
+            case BLADERF_FPGA_40KLE:
+                sprintf( fpgaFile , "./hostedx40.rbf" ) ;
+                break;
+            case BLADERF_FPGA_115KLE:
+                sprintf(fpgaFile , "./hostedx115.rbf" );
+                break;
+            default:
+            case BLADERF_FPGA_UNKNOWN:
+                fprintf( stderr, "%s : %s unknown FPGA size\n", __func__, devinfo->serial );
+                releaseDevice( dev );
+                return( BLADERF_ERR_UNSUPPORTED );
+            }
+            rc = bladerf_load_fpga( dev->bladerf_device, fpgaFile  );
+            if( rc != 0 ) {
+                fprintf( stderr, "%s : %s cannot load %s, %s\n", __func__, devinfo->serial, fpgaFile, bladerf_strerror(rc));
+                releaseDevice( dev );
+                return( rc );
+            }
+
+        }
+    }
+    dev->bringup_ms[BRINGUP_FPGA] = elapsedMs( &t0 );
+    dev->uuid = NULL ;
+    dev->running = false ;
+    dev->acq_stop = false ;
+    dev->device_serial_number = (char *)malloc( 255 *sizeof(char));
+    bladerf_get_serial( dev->bladerf_device, dev->device_serial_number );
+
+    // engine, buffering, stream geometry and placement, see device_config.h
+    device_config_read( root_json, dev->device_serial_number, devinfo->usb_bus, &dev->config );
+
+    dev->min_frq_hz = BLADERF_FREQUENCY_MIN ;
+    dev->max_frq_hz = BLADERF_FREQUENCY_MAX ;
+    dev->center_frq_hz = dev->min_frq_hz + 1e6 ; // arbitrary startup freq
+
+    // allocate rates
+    dev->rates = (struct t_sample_rates*)malloc( sizeof(struct t_sample_rates));
+
+    int hw_rates = 7 ; // we manage 7 different hardware sampling rates
+    dev->rates->enum_length = hw_rates ;
+    if( dev->config.resampler ) {
+        dev->rates->enum_length += DECIMATED_RATES_COUNT ;
+    }
+    dev->rates->sample_rates = (unsigned int *)malloc( dev->rates->enum_length * sizeof( unsigned int )) ;
+    dev->rates->rf_filter_bw = (unsigned int *)malloc( dev->rates->enum_length * sizeof( unsigned int )) ;
+
+    dev->rates->sample_rates[0] = 2*1024*1000u ;
+    dev->rates->sample_rates[1] = 4*1024*1000u ;
+    dev->rates->sample_rates[2] = 6*1024*1000u ;
+    dev->rates->sample_rates[3] = 8*1024*1000u ;
+    dev->rates->sample_rates[4] = 10*1024*1000u ;
+    dev->rates->sample_rates[5] = 12*1024*1000u ;
+    dev->rates->sample_rates[6] = 14*1024*1000u ;
+
+    dev->rates->preffered_sr_index = 0 ; // our default sampling rate will be 2048 KHz
+    // set startup freq, after the quick tune values of the frequencies we expect to hop to
+    tune_cache_init( &dev->tune_cache );
+    dev->hop_timestamp = 0 ;
+    dev->hop_from_hz = 0 ;
+    dev->quick_retunes = 0 ;
+    dev->scheduled_retunes = 0 ;
+    if( dev->config.quick_tune ) {
+        prewarmTuneCache( dev );
+    }
+    rc = moveLo( dev, dev->center_frq_hz, false );
+    dev->lo_frq_hz = dev->center_frq_hz ;
+    dev->nco_request_hz = 0 ;
+    dev->nco_shift_hz = 0 ;
+    dev->nco_rate = 0 ;
+    memset( &dev->nco, 0, sizeof(dev->nco));
+    dev->lo_retunes = 0 ;
+    dev->nco_retunes = 0 ;
+
+    // select filters, decimated rates use the analog filter of the hardware rate they are computed from
+    clock_gettime( CLOCK_MONOTONIC, &t0 );
+    for( int f=hw_rates ; f < dev->rates->enum_length ; f++ ) {
+        dev->rates->sample_rates[f] = decimated_rates[f - hw_rates].rate ;
+    }
+    for( int f=0 ; f < dev->rates->enum_length ; f++ ) {
+        unsigned int rate = dev->rates->sample_rates[f] ;
+        dev->rates->rf_filter_bw[f] = planFilter( f < hw_rates ? rate : decimated_rates[f - hw_rates].hw_rate );
+        if( DEBUG_DRIVER ) fprintf(stderr,"For rate %3.1f, selected filter is %3.1f\n", rate/1000.0, 2*dev->rates->rf_filter_bw[f]/1000.0 );
+    }
+    dev->bringup_ms[BRINGUP_FILTERS] = elapsedMs( &t0 );
+
+    // set  SR
+    clock_gettime( CLOCK_MONOTONIC, &t0 );
+    rc = dev->rates->preffered_sr_index ;
+    dev->current_sample_rate = dev->rates->sample_rates[rc] ;
+    bladerf_set_sample_rate( dev->bladerf_device, BLADERF_MODULE_RX,
+                             dev->current_sample_rate,
+                             &dev->current_sample_rate);
+    dev->output_sample_rate = dev->current_sample_rate ;
+    dev->resampler_request = 0 ;
+    dev->resampler_ratio = 0 ;
+    dev->resampler = NULL ;
+    dev->channelizer = NULL ;
+    dev->channelizer_rate = 0 ;
+    dev->channelizer_base = 0 ;
+    dev->output_sample_rate = outputRate( dev, dev->current_sample_rate );
+    unsigned int actual_rx_hwfilter ;
+    bladerf_set_bandwidth( dev->bladerf_device, BLADERF_MODULE_RX, dev->rates->rf_filter_bw[rc],&actual_rx_hwfilter);
+    setBladeRxGain( dev, BLADERF_LNA_GAIN_MID_DB, 0 ) ;
+    setBladeRxGain( dev, (float)(BLADERF_RXVGA1_GAIN_MIN+(BLADERF_RXVGA1_GAIN_MAX-BLADERF_RXVGA1_GAIN_MIN)/2) , 1 ) ;
+    setBladeRxGain( dev, (float)(BLADERF_RXVGA2_GAIN_MIN+(BLADERF_RXVGA2_GAIN_MAX-BLADERF_RXVGA2_GAIN_MIN)/2) , 2 ) ;
+
+    dev->gain[0] = (float)BLADERF_LNA_GAIN_MID_DB ;
+    dev->gain[1] = (float)(BLADERF_RXVGA1_GAIN_MIN+(BLADERF_RXVGA1_GAIN_MAX-BLADERF_RXVGA1_GAIN_MIN)/2)  ;
+    dev->gain[2] = (float)(BLADERF_RXVGA2_GAIN_MIN+(BLADERF_RXVGA2_GAIN_MAX-BLADERF_RXVGA2_GAIN_MIN)/2) ;
+
+    memset( &dev->ext_context, 0, sizeof(dev->ext_context));
+    dev->ext_context.ctx_version = EXT_CONTEXT_VERSION ;
+    dev->ext_context.center_freq = dev->center_frq_hz ;
+    dev->ext_context.sample_rate = dev->output_sample_rate ;
+    dev->ext_context.hw_sample_rate = dev->current_sample_rate ;
+    dev->push_next_timestamp = 0 ;
+    if( dev->config.offset_tuning ) {
+        tuneRx( dev, dev->center_frq_hz ); // move the LO away
+    }
+
+    device_config_geometry( &dev->config, dev->current_sample_rate, &dev->geometry );
+    dev->requested_geometry = dev->geometry ;
+    dev->geometry_serial = 0 ;
+    dev->geometry_applied = 0 ;
+    memset( &dev->stream_geometry, 0, sizeof(dev->stream_geometry));
+
+    // blocks and slots are sized once for the largest push the rate range can ask for
+    struct t_stream_geometry largest ;
+    device_config_geometry( &dev->config, BLADERF_SAMPLERATE_REC_MAX, &largest );
+    unsigned int block_samples = largest.push_samples ;
+    if( block_samples < dev->geometry.push_samples ) {
+        block_samples = dev->geometry.push_samples ;
+    }
+    if( DEBUG_DRIVER ) fprintf(stderr,"%s : %s buffers=%u buffer_size=%u transfers=%u push_samples=%u\n", __func__,
+                               dev->device_serial_number, dev->geometry.num_buffers, dev->geometry.buffer_size,
+                               dev->geometry.num_transfers, dev->geometry.push_samples );
+    dev->stream = NULL ;
+    dev->stream_buffers = NULL ;
+    dev->cur_block = NULL ;
+    dev->cur_fill = 0 ;
+
+    // ring of raw sample blocks between the receive and the DSP threads,
+    // without it conversion and push are done by the receiving thread
+    dev->ring = NULL ;
+    dev->cur_slot = NULL ;
+    if( dev->config.ring_depth > 0 ) {
+        dev->ring = stream_ring_create( dev->config.ring_depth, block_samples );
+    }
+
+    memset( &dev->dc, 0, sizeof(dev->dc));
+    rx_stats_reset( &dev->stats );
+    control_queue_init( &dev->control );
+    dev->control_busy = 0 ;
+    dev->control_serial = 0 ;
+    dev->control_seen = 0 ;
+    dev->pool = sample_pool_create( dev->config.pool_blocks, block_samples, dev->config.pool_host_release );
+    if( dev->pool == NULL || (dev->config.ring_depth > 0 && dev->ring == NULL)) {
+        fprintf( stderr, "%s : %s cannot allocate the sample buffers\n", __func__, dev->device_serial_number );
+        releaseDevice( dev );
+        return( BLADERF_ERR_MEM );
+    }
+    dev->bringup_ms[BRINGUP_SETUP] = elapsedMs( &t0 );
+    return( 0 );
+}
+
+/**
+ * @brief startDevice creates the synchronisation objects and threads of a device once it has its final place in rx[]
+ * @param dev
+ */
+static void startDevice( struct t_rx_device *dev ) {
+    sem_init(&dev->mutex, 0, 0);
+    pthread_mutex_init( &dev->geometry_lock, NULL );
+    pthread_mutex_init( &dev->sweep_lock, NULL );
+
+    // create acquisition threads
+    pthread_create(&dev->receive_thread, NULL, acquisition_thread, dev );
+    if( dev->ring != NULL ) {
+        pthread_create(&dev->process_thread, NULL, dsp_thread, dev );
+    }
+}
+
+// devices shared between the bring-up workers, each worker takes the next index
+struct t_bringup {
+    struct t_rx_device *devices ;
+    struct bladerf_devinfo *devinfo ;
+    int *status ;
+    int count ;
+    int next ;
+};
 
+void* bringup_worker( void *params ) {
+    struct t_bringup *bringup = (struct t_bringup *)params ;
+    for( ;; ) {
+        int k = __atomic_fetch_add( &bringup->next, 1, __ATOMIC_RELAXED );
+        if( k >= bringup->count ) {
+            break ;
+        }
+        bringup->status[k] = bringupDevice( &bringup->devices[k], &bringup->devinfo[k] );
+    }
+    return(NULL);
+}
 
 /*
  * First function called by SDRNode - must return 0 if hardware is not present or problem
@@ -137,7 +829,6 @@ LIBRARY_API int initLibrary(char *json_init_params,
     json_error_t error;
     root_json = NULL ;
     struct t_rx_device *tmp ;
-    int rc ;
 
     sdrNode_LogFunction = ptr ;
     acqCbFunction = acqCb ;
@@ -151,120 +842,89 @@ LIBRARY_API int initLibrary(char *json_init_params,
     driver_name = (char *)malloc( 100*sizeof(char));
     snprintf(driver_name,100,"BladeRF");
 
+    // select the SC16Q11 to float conversion kernel for this CPU
+    const char *kernel_name = dsp_kernels_init();
+    if( DEBUG_DRIVER ) fprintf(stderr,"%s : using %s conversion kernel\n", __func__, kernel_name );
+
     // Step 1 : count how many devices we have
     bladerf_devinfo* g_devinfo ;
     device_count = bladerf_get_device_list(&g_devinfo);
-    if( device_count == 0 ) {
+    if( device_count <= 0 ) {
+        device_count = 0 ;
         return(0); // no hardware
     }
 
     rx = (struct t_rx_device *)malloc( device_count * sizeof(struct t_rx_device));
     if( rx == NULL ) {
+        bladerf_free_device_list( g_devinfo );
+        device_count = 0 ;
         return(0);
     }
-    tmp = rx ;
-    // iterate through devices to populate structure
-    for( int k=0 ; k < device_count; k++ ) {
-        tmp->device_name = (char *)malloc( 64 *sizeof(char));
-        sprintf( tmp->device_name, "BladeRF");
-        rc = bladerf_open_with_devinfo( &tmp->bladerf_device, &g_devinfo[k] );
-        if( !bladerf_is_fpga_configured( tmp->bladerf_device )) {
-            bladerf_fpga_size size = BLADERF_FPGA_UNKNOWN;
-            rc = bladerf_get_fpga_size( tmp->bladerf_device, &size);
-            if (!rc && (size == BLADERF_FPGA_UNKNOWN)) {
-                size = BLADERF_FPGA_40KLE;
-            }
-            if( !rc ) {
-                char fpgaFile[255];
-                switch (size)
-                {
-                case BLADERF_FPGA_40KLE:
-                    sprintf( fpgaFile , "./hostedx40.rbf" ) ;
-                    break;
-                case BLADERF_FPGA_115KLE:
-                    sprintf(fpgaFile , "./hostedx115.rbf" );
-                    break;
-                default:
-                case BLADERF_FPGA_UNKNOWN: continue;
-                }
-                rc = bladerf_load_fpga( tmp->bladerf_device, fpgaFile  );
-                if( rc != 0 ) {
-                    continue ;
-                }
 
-            }
+    // bring the boards up concurrently : opening, FPGA loading and the filter sweep are mostly
+    // spent waiting on USB round trips for one board
+    struct t_bringup bringup ;
+    int *status = (int *)malloc( device_count * sizeof(int));
+    if( status == NULL ) {
+        bladerf_free_device_list( g_devinfo );
+        free( rx );
+        rx = NULL ;
+        device_count = 0 ;
+        return(0);
+    }
+    bringup.devices = rx ;
+    bringup.devinfo = g_devinfo ;
+    bringup.status = status ;
+    bringup.count = device_count ;
+    bringup.next = 0 ;
+
+    int workers = device_config_bringup_workers( root_json );
+    if( workers > device_count ) {
+        workers = device_count ;
+    }
+    pthread_t *worker_threads = (pthread_t *)malloc( workers * sizeof(pthread_t));
+    int started = 0 ;
+    while( worker_threads != NULL && started < workers ) {
+        if( pthread_create( &worker_threads[started], NULL, bringup_worker, &bringup ) != 0 ) {
+            break ;
         }
-        sem_init(&tmp->mutex, 0, 0);
-        tmp->uuid = NULL ;
-        tmp->running = false ;
-        tmp->acq_stop = false ;
-        tmp->device_serial_number = (char *)malloc( 255 *sizeof(char));
-        bladerf_get_serial( tmp->bladerf_device, tmp->device_serial_number );
-
-
-        tmp->min_frq_hz = BLADERF_FREQUENCY_MIN ;
-        tmp->max_frq_hz = BLADERF_FREQUENCY_MAX ;
-        tmp->center_frq_hz = tmp->min_frq_hz + 1e6 ; // arbitrary startup freq
-
-        // allocate rates
-        tmp->rates = (struct t_sample_rates*)malloc( sizeof(struct t_sample_rates));
-
-        tmp->rates->enum_length = 7 ; // we manage 5 different sampling rates
-        tmp->rates->sample_rates = (unsigned int *)malloc( tmp->rates->enum_length * sizeof( unsigned int )) ;
-        tmp->rates->rf_filter_bw = (unsigned int *)malloc( tmp->rates->enum_length * sizeof( unsigned int )) ;
-
-        tmp->rates->sample_rates[0] = 2*1024*1000u ;
-        tmp->rates->sample_rates[1] = 4*1024*1000u ;
-        tmp->rates->sample_rates[2] = 6*1024*1000u ;
-        tmp->rates->sample_rates[3] = 8*1024*1000u ;
-        tmp->rates->sample_rates[4] = 10*1024*1000u ;
-        tmp->rates->sample_rates[5] = 12*1024*1000u ;
-        tmp->rates->sample_rates[6] = 14*1024*1000u ;
-
-        tmp->rates->preffered_sr_index = 0 ; // our default sampling rate will be 2048 KHz
-        // set startup freq
-        rc = bladerf_set_frequency( tmp->bladerf_device, BLADERF_MODULE_RX, tmp->center_frq_hz );
-
-        // check filters
-        for( int f=0 ; f < tmp->rates->enum_length ; f++ ) {
-            unsigned int rate = tmp->rates->sample_rates[f] ;
-            unsigned int filter = rate*2 ;
-
-            if( DEBUG_DRIVER ) fprintf(stderr,"\nSearching filter rate[%d]=%d \n", f, (int)rate  );
-            for( int x=FILTER_TAB_LENGTH-1 ; x>=0; x--) {
-                bladerf_set_bandwidth( tmp->bladerf_device, BLADERF_MODULE_RX, lms_filters[x], &filter );
-                tmp->rates->rf_filter_bw[f] = filter ;
-                if( filter*2 < rate ) {
-                    break ;
-                }
-            }
+        started++ ;
+    }
+    if( started == 0 ) {
+        bringup_worker( &bringup ); // no thread available, do it from here
+    }
+    for( int w=0 ; w < started ; w++ ) {
+        pthread_join( worker_threads[w], NULL );
+    }
+    free( worker_threads );
 
-            if( DEBUG_DRIVER ) fprintf(stderr,"For rate %3.1f, selected filter is %3.1f\n", rate/1000.0, 2*tmp->rates->rf_filter_bw[f]/1000.0 );
+    // keep the boards that came up, in enumeration order, so device ids stay dense
+    int ready = 0 ;
+    for( int k=0 ; k < device_count; k++ ) {
+        if( status[k] != 0 ) {
+            fprintf( stderr, "%s : device %d (%s) dropped, %s\n", __func__, k, g_devinfo[k].serial, bladerf_strerror(status[k]));
+            continue ;
         }
+        if( ready != k ) {
+            memcpy( &rx[ready], &rx[k], sizeof(struct t_rx_device));
+        }
+        tmp = &rx[ready] ;
+        if( DEBUG_DRIVER ) fprintf(stderr,"%s : %s open %.0f ms, fpga %.0f ms, filters %.0f ms, setup %.0f ms\n", __func__,
+                                   tmp->device_serial_number, tmp->bringup_ms[BRINGUP_OPEN], tmp->bringup_ms[BRINGUP_FPGA],
+                                   tmp->bringup_ms[BRINGUP_FILTERS], tmp->bringup_ms[BRINGUP_SETUP] );
+        ready++ ;
+    }
+    free( status );
+    bladerf_free_device_list( g_devinfo );
+    device_count = ready ;
+    if( device_count == 0 ) {
+        free( rx );
+        rx = NULL ;
+        return(0);
+    }
 
-        // set  SR
-        rc = tmp->rates->preffered_sr_index ;
-        tmp->current_sample_rate = tmp->rates->sample_rates[rc] ;
-        bladerf_set_sample_rate( tmp->bladerf_device, BLADERF_MODULE_RX,
-                                 tmp->current_sample_rate,
-                                 &tmp->current_sample_rate);
-        unsigned int actual_rx_hwfilter ;
-        bladerf_set_bandwidth( tmp->bladerf_device, BLADERF_MODULE_RX, tmp->rates->rf_filter_bw[rc],&actual_rx_hwfilter);
-        setBladeRxGain( tmp, BLADERF_LNA_GAIN_MID_DB, 0 ) ;
-        setBladeRxGain( tmp, (float)(BLADERF_RXVGA1_GAIN_MIN+(BLADERF_RXVGA1_GAIN_MAX-BLADERF_RXVGA1_GAIN_MIN)/2) , 1 ) ;
-        setBladeRxGain( tmp, (float)(BLADERF_RXVGA2_GAIN_MIN+(BLADERF_RXVGA2_GAIN_MAX-BLADERF_RXVGA2_GAIN_MIN)/2) , 2 ) ;
-
-        tmp->gain[0] = (float)BLADERF_LNA_GAIN_MID_DB ;
-        tmp->gain[1] = (float)(BLADERF_RXVGA1_GAIN_MIN+(BLADERF_RXVGA1_GAIN_MAX-BLADERF_RXVGA1_GAIN_MIN)/2)  ;
-        tmp->gain[2] = (float)(BLADERF_RXVGA2_GAIN_MIN+(BLADERF_RXVGA2_GAIN_MAX-BLADERF_RXVGA2_GAIN_MIN)/2) ;
-
-        tmp->ext_context.ctx_version = 0 ;
-        tmp->ext_context.center_freq = tmp->center_frq_hz ;
-        tmp->ext_context.sample_rate = tmp->current_sample_rate ;
-
-        // create acquisition threads
-        pthread_create(&tmp->receive_thread, NULL, acquisition_thread, tmp );
-
+    for( int k=0 ; k < device_count; k++ ) {
+        startDevice( &rx[k] );
     }
 
     // set names for stages
@@ -552,34 +1212,60 @@ LIBRARY_API int finalizeRXEngine( int device_id ) {
  * @return
  */
 LIBRARY_API int setRxSampleRate( int device_id , int sample_rate) {
-    int rc ;
     if( DEBUG_DRIVER ) fprintf(stderr,"%s(%d,%d)\n", __func__, device_id,sample_rate);
-    if( device_id >= device_count )
+    if( device_id >= device_count || sample_rate <= 0 )
         return(RC_NOK);
 
-    struct t_rx_device *dev = &rx[device_id] ;
-    if( (unsigned int)sample_rate == dev->current_sample_rate ) {
+    struct t_control_cmd cmd ;
+    memset( &cmd, 0, sizeof(cmd));
+    cmd.type = CONTROL_SET_SAMPLE_RATE ;
+    cmd.value = sample_rate ;
+    return( submitControl( &rx[device_id], &cmd ));
+}
+
+/**
+ * @brief applySampleRate sets the hardware rate, the analog filter and the decimation for sample_rate
+ * @param dev
+ * @param sample_rate
+ * @return RC_OK or RC_NOK
+ */
+static int applySampleRate( struct t_rx_device *dev, int sample_rate ) {
+    int rc ;
+    if( (unsigned int)sample_rate == dev->output_sample_rate ) {
         return(RC_OK);
     }
 
+    // decimated rates : the hardware runs at hw_rate and the resampler does the rest
+    unsigned int hw_rate = sample_rate ;
+    uint64_t ratio = 0 ;
+    if( dev->config.resampler ) {
+        for( int d=0 ; d < DECIMATED_RATES_COUNT ; d++ ) {
+            if( decimated_rates[d].rate == (unsigned int)sample_rate ) {
+                hw_rate = decimated_rates[d].hw_rate ;
+                ratio = ((uint64_t)decimated_rates[d].interp << 32) | decimated_rates[d].decim ;
+            }
+        }
+    }
+
     rc = bladerf_set_sample_rate( dev->bladerf_device, BLADERF_MODULE_RX,
-                             sample_rate,
+                             hw_rate,
                              &dev->current_sample_rate);
     if( rc != 0 ) {
         fprintf( stderr, "%f(%d) error rc=%d\n", __func__, sample_rate, rc );
         return( RC_NOK );
     }
-
-    unsigned int filter ;
-    for( int f=0 ; f < dev->rates->enum_length ; f++ ) {
-        unsigned int rate = dev->rates->sample_rates[f] ;
-        if( rate == sample_rate ) {
-            bladerf_set_bandwidth( dev->bladerf_device, BLADERF_MODULE_RX,
-                                     dev->rates->rf_filter_bw[f],
-                                     &filter );
-            if( DEBUG_DRIVER ) fprintf(stderr,"setRxSampleRate rate %3.1f, filter set %3.1f\n", rate/1000.0, 2*dev->rates->rf_filter_bw[f]/1000.0 );
-        }
-
+    dev->output_sample_rate = ratio != 0 ? (unsigned int)sample_rate : outputRate( dev, dev->current_sample_rate );
+    __atomic_store_n( &dev->resampler_request, ratio, __ATOMIC_RELEASE );
+
+    // any rate gets the filter planned for the hardware rate actually set
+    unsigned int filter = planFilter( dev->current_sample_rate );
+    bladerf_set_bandwidth( dev->bladerf_device, BLADERF_MODULE_RX, filter, &filter );
+    if( DEBUG_DRIVER ) fprintf(stderr,"setRxSampleRate rate %3.1f, filter set %3.1f\n", sample_rate/1000.0, 2*filter/1000.0 );
+    if( dev->config.stream_profile == STREAM_PROFILE_AUTO ) {
+        requestGeometry( dev );
+    }
+    if( dev->config.offset_tuning ) {
+        tuneRx( dev, dev->center_frq_hz ); // the NCO range follows the rate
     }
     fflush(stderr);
     return(RC_OK);
@@ -595,7 +1281,67 @@ LIBRARY_API int getActualRxSampleRate( int device_id ) {
     if( device_id >= device_count )
         return(RC_NOK);
     struct t_rx_device *dev = &rx[device_id] ;
-    return(dev->current_sample_rate);
+    return(dev->output_sample_rate);
+}
+
+/**
+ * @brief getStreamGeometry reports the buffering chosen for the current sample rate. Any pointer can be NULL
+ * @param device_id
+ * @param push_samples IQ samples per block given to the push callback
+ * @param buffer_size IQ samples per USB buffer
+ * @param num_buffers
+ * @param num_transfers USB transfers in flight
+ * @return RC_OK
+ */
+LIBRARY_API int getStreamGeometry( int device_id, unsigned int *push_samples, unsigned int *buffer_size,
+                                   unsigned int *num_buffers, unsigned int *num_transfers ) {
+    if( device_id >= device_count )
+        return(RC_NOK);
+    struct t_rx_device *dev = &rx[device_id] ;
+    struct t_stream_geometry g ;
+
+    pthread_mutex_lock( &dev->geometry_lock );
+    g = dev->requested_geometry ;
+    pthread_mutex_unlock( &dev->geometry_lock );
+
+    if( push_samples != NULL ) *push_samples = g.push_samples ;
+    if( buffer_size != NULL ) *buffer_size = g.buffer_size ;
+    if( num_buffers != NULL ) *num_buffers = g.num_buffers ;
+    if( num_transfers != NULL ) *num_transfers = g.num_transfers ;
+    return(RC_OK);
+}
+
+/**
+ * @brief getStreamStats copies the streaming counters of the device, can be called at any time from any thread
+ * @param device_id
+ * @param stats
+ * @return RC_OK
+ */
+LIBRARY_API int getStreamStats( int device_id, struct t_stream_stats *stats ) {
+    if( device_id >= device_count || stats == NULL )
+        return(RC_NOK);
+    struct t_rx_device *dev = &rx[device_id] ;
+    const struct t_rx_stats *st = &dev->stats ;
+
+    memset( stats, 0, sizeof(struct t_stream_stats));
+    stats->samples_received = __atomic_load_n( &st->samples_received, __ATOMIC_RELAXED );
+    stats->samples_pushed = __atomic_load_n( &st->samples_pushed, __ATOMIC_RELAXED );
+    stats->blocks_pushed = __atomic_load_n( &st->blocks_pushed, __ATOMIC_RELAXED );
+    stats->overruns = __atomic_load_n( &st->overruns, __ATOMIC_RELAXED );
+    stats->samples_lost = __atomic_load_n( &st->samples_lost, __ATOMIC_RELAXED );
+    stats->short_transfers = __atomic_load_n( &st->short_transfers, __ATOMIC_RELAXED );
+    if( dev->ring != NULL ) {
+        stats->ring_depth = dev->ring->depth ;
+        stats->ring_high_water = __atomic_load_n( &dev->ring->stats.high_water, __ATOMIC_RELAXED );
+        stats->ring_overruns = __atomic_load_n( &dev->ring->stats.overruns, __ATOMIC_RELAXED );
+        stats->ring_dropped_samples = __atomic_load_n( &dev->ring->stats.dropped_samples, __ATOMIC_RELAXED );
+    }
+    stats->pool_exhausted = __atomic_load_n( &dev->pool->stats.exhausted, __ATOMIC_RELAXED );
+    stats->push_latency_p50_us = rx_stats_latency_percentile( st, 50 );
+    stats->push_latency_p90_us = rx_stats_latency_percentile( st, 90 );
+    stats->push_latency_p99_us = rx_stats_latency_percentile( st, 99 );
+    stats->push_latency_max_us = (unsigned int)__atomic_load_n( &st->latency_max_us, __ATOMIC_RELAXED );
+    return(RC_OK);
 }
 
 /**
@@ -611,14 +1357,16 @@ LIBRARY_API int setRxCenterFreq( int device_id, int64_t frq_hz ) {
         return(RC_NOK);
 
     struct t_rx_device *dev = &rx[device_id] ;
-    int rc = bladerf_set_frequency( dev->bladerf_device, BLADERF_MODULE_RX, frq_hz );
-    if( rc == 0 ) {
-        dev->center_frq_hz = frq_hz ;
-        return(RC_OK);
+    if( frq_hz < dev->min_frq_hz || frq_hz > dev->max_frq_hz ) {
+        if( DEBUG_DRIVER ) fprintf(stderr,"ERROR : %s(%d,%ld)\n", __func__, device_id, (long)frq_hz);
+        if( DEBUG_DRIVER ) fflush(stderr);
+        return(RC_NOK);
     }
-    if( DEBUG_DRIVER ) fprintf(stderr,"ERROR : %s(%d,%ld)\n", __func__, device_id, (long)frq_hz);
-    if( DEBUG_DRIVER ) fflush(stderr);
-    return(RC_NOK);
+    struct t_control_cmd cmd ;
+    memset( &cmd, 0, sizeof(cmd));
+    cmd.type = CONTROL_SET_FREQUENCY ;
+    cmd.value = frq_hz ;
+    return( submitControl( dev, &cmd ));
 }
 
 /**
@@ -633,6 +1381,9 @@ LIBRARY_API int64_t getRxCenterFreq( int device_id ) {
         return(RC_NOK);
 
     struct t_rx_device *dev = &rx[device_id] ;
+    if( dev->config.offset_tuning ) {
+        return( dev->center_frq_hz ) ; // the LO is away from the tuned frequency
+    }
     bladerf_get_frequency( dev->bladerf_device, BLADERF_MODULE_RX, &frequency );
     if( frequency > 0 ) {
         dev->center_frq_hz = (int64_t)frequency ;
@@ -654,8 +1405,12 @@ LIBRARY_API int setRxGain( int device_id, int stage_id, float gain_value ) {
     if( stage_id >= 1 )
         return(RC_NOK);
 
-    struct t_rx_device *dev = &rx[device_id] ;
-    return( setBladeRxGain( dev, gain_value, stage_id ));
+    struct t_control_cmd cmd ;
+    memset( &cmd, 0, sizeof(cmd));
+    cmd.type = CONTROL_SET_GAIN ;
+    cmd.stage = stage_id ;
+    cmd.gain = gain_value ;
+    return( submitControl( &rx[device_id], &cmd ));
 }
 
 /**
@@ -682,70 +1437,848 @@ LIBRARY_API bool setAutoGainMode( int device_id ) {
     return(false);
 }
 
-//-----------------------------------------------------------------------------------------
-// functions below are RTLSDR specific
-// One thread is started by device, and each sample frame calls rtlsdr_callback() with a block
-// of IQ samples as bytes.
-// Samples are converted to float, DC is removed and finally samples are passed to SDRNode
-//
-
-
-#define ALPHA_DC (0.9996)
-
-
 /**
- * @brief acquisition_thread This function is locked by the mutex and waits before starting the acquisition in asynch mode
- * @param params
- * @return
+ * @brief releaseSamples gives back a sample block kept by the host (push callback returned > 0).
+ *        Only valid when the driver was initialized with "sample_pool" : { "host_release" : true }
+ * @param device_id
+ * @param samples the pointer received by the push callback
+ * @return RC_OK if the block was taken back, RC_NOK if the host did not hold it (released twice, never kept)
  */
-#define DEFAULT_STREAM_XFERS 64
-#define DEFAULT_STREAM_BUFFERS 32
-#define DEFAULT_STREAM_SAMPLES 8192
-#define DEFAULT_STREAM_TIMEOUT 5000
-
-#define DEFAULT_STREAM_BUFFERSIZE 8192*4
-#define DEFAULT_STREAM_NUMTRANSFERS 16
-void* acquisition_thread( void *params ) {
-    int rc ;
-    int16_t *ptr;
-    struct bladerf_metadata meta;
-    struct t_rx_device* dev = (struct t_rx_device*)params ;
-    bladerf *bladerf_device = dev->bladerf_device ;
-    float I,Q ;
-    TYPECPX tmp;
+LIBRARY_API int releaseSamples( int device_id, float *samples ) {
+    if( device_id >= device_count )
+        return(RC_NOK);
+    if( samples == NULL )
+        return(RC_NOK);
+    struct t_rx_device *dev = &rx[device_id] ;
+    if( dev->pool == NULL || !dev->pool->host_release )
+        return(RC_NOK);
+    return( sample_pool_release( dev->pool, samples ) == 0 ? RC_OK : RC_NOK );
+}
 
-    // calibration procedure
-    rc = bladerf_enable_module(  bladerf_device, BLADERF_MODULE_TX, true);
+/**
+ * @brief startSweep scans the frequencies in a loop with retunes scheduled on the FPGA timeline : after each hop,
+ *        settle_us of samples are dropped and the next dwell_samples are pushed as one block, at the hardware rate,
+ *        flagged EXT_CTX_FLAG_SWEEP with the frequency and timestamp of the dwell. Replaces a running sweep.
+ *        Sync engine only, frequency changes wait for stopSweep()
+ * @param device_id
+ * @param frequencies
+ * @param count
+ * @param dwell_samples at most the size of a pool block
+ * @param settle_us
+ * @return RC_OK or RC_NOK
+ */
+LIBRARY_API int startSweep( int device_id, const int64_t *frequencies, int count, unsigned int dwell_samples, unsigned int settle_us ) {
+    if( DEBUG_DRIVER ) fprintf(stderr,"%s(%d,%d,%u,%u)\n", __func__, device_id, count, dwell_samples, settle_us );
+    if( device_id >= device_count || frequencies == NULL || count <= 0 || count > SWEEP_MAX_FREQUENCIES )
+        return(RC_NOK);
+
+    struct t_rx_device *dev = &rx[device_id] ;
+    if( dev->config.rx_engine != RX_ENGINE_SYNC || dwell_samples == 0 || dwell_samples > dev->pool->block_samples )
+        return(RC_NOK);
+    for( int i=0 ; i < count ; i++ ) {
+        if( frequencies[i] < dev->min_frq_hz || frequencies[i] > dev->max_frq_hz )
+            return(RC_NOK);
+    }
+
+    struct t_sweep_plan plan ;
+    plan.count = count ;
+    plan.frequency = (int64_t *)frequencies ;
+    plan.dwell_samples = dwell_samples ;
+    plan.settle_us = settle_us ;
+    struct t_sweep *sweep = sweep_create( &plan );
+    if( sweep == NULL )
+        return(RC_NOK);
+
+    pthread_mutex_lock( &dev->sweep_lock );
+    sweep_free( dev->sweep_request ); // not taken yet
+    dev->sweep_request = sweep ;
+    __atomic_add_fetch( &dev->sweep_serial, 1, __ATOMIC_RELEASE );
+    pthread_mutex_unlock( &dev->sweep_lock );
+    return(RC_OK);
+}
+
+/**
+ * @brief stopSweep goes back to streaming at the frequency set by setRxCenterFreq()
+ * @param device_id
+ * @return RC_OK
+ */
+LIBRARY_API int stopSweep( int device_id ) {
+    if( DEBUG_DRIVER ) fprintf(stderr,"%s(%d)\n", __func__, device_id );
+    if( device_id >= device_count )
+        return(RC_NOK);
+
+    struct t_rx_device *dev = &rx[device_id] ;
+    pthread_mutex_lock( &dev->sweep_lock );
+    sweep_free( dev->sweep_request );
+    dev->sweep_request = NULL ;
+    __atomic_add_fetch( &dev->sweep_serial, 1, __ATOMIC_RELEASE );
+    pthread_mutex_unlock( &dev->sweep_lock );
+    return(RC_OK);
+}
+
+//-----------------------------------------------------------------------------------------
+// functions below are RTLSDR specific
+// One thread is started by device, and each sample frame calls rtlsdr_callback() with a block
+// of IQ samples as bytes.
+// Samples are converted to float, DC is removed and finally samples are passed to SDRNode
+//
+
+
+
+/**
+ * @brief deliver_block pushes a pool block to SDRNode and gives it back to the pool if the callback did not keep it
+ * @param dev
+ * @param samples
+ * @param count samples per channel
+ * @param channels
+ * @param ctx context given with the block
+ */
+static void deliver_block( struct t_rx_device* dev, TYPECPX *samples, int count, int channels, struct ext_Context *ctx ) {
+    struct timespec t0, t1 ;
+
+    // push samples to SDRNode callback function
+    sample_pool_lend( dev->pool, (float *)samples );
+    clock_gettime( CLOCK_MONOTONIC, &t0 );
+    int kept = (*acqCbFunction)( dev->uuid, (float *)samples, count, channels, ctx ) ;
+    ctx->flags &= ~(EXT_CTX_FLAG_DISCONTINUITY | EXT_CTX_FLAG_CONTROL) ; // next block of the same input follows this one
+    clock_gettime( CLOCK_MONOTONIC, &t1 );
+    rx_stats_pushed( &dev->stats, count * channels,
+                     (uint64_t)(t1.tv_sec - t0.tv_sec) * 1000000000ull + t1.tv_nsec - t0.tv_nsec );
+    if( kept <= 0 ) {
+        sample_pool_recycle( dev->pool, (float *)samples );
+    } else {
+        sample_pool_handoff( dev->pool, (float *)samples );
+    }
+}
+
+/**
+ * @brief set_block_context fills the context given with the next pushed blocks
+ * @param dev
+ * @param timestamp of the first hardware sample of the input block, 0 if unknown
+ * @param count input block length, in hardware samples
+ * @param output_rate rate of the pushed samples
+ */
+static void set_block_context( struct t_rx_device* dev, uint64_t timestamp, int count, unsigned int output_rate ) {
+    struct ext_Context *ctx = &dev->ext_context ;
+    int64_t center = __atomic_load_n( &dev->center_frq_hz, __ATOMIC_ACQUIRE );
+    uint64_t hop = __atomic_load_n( &dev->hop_timestamp, __ATOMIC_ACQUIRE );
+    unsigned int hw_rate = __atomic_load_n( &dev->current_sample_rate, __ATOMIC_RELAXED );
+    unsigned int serial = __atomic_load_n( &dev->control_serial, __ATOMIC_ACQUIRE );
+    // a discontinuity stays flagged until a block carrying it has been pushed
+    unsigned int flags = ctx->flags & (EXT_CTX_FLAG_DISCONTINUITY | EXT_CTX_FLAG_CONTROL) ;
+
+    if( hop != 0 && timestamp != 0 && timestamp < hop ) {
+        center = __atomic_load_n( &dev->hop_from_hz, __ATOMIC_RELAXED ); // the FPGA has not hopped yet
+    }
+    if( serial != dev->control_seen ) {
+        flags |= EXT_CTX_FLAG_CONTROL ;
+        dev->control_seen = serial ;
+    }
+    if( timestamp != 0 ) {
+        flags |= EXT_CTX_FLAG_TIMESTAMP ;
+    }
+    if( timestamp == 0 || timestamp != dev->push_next_timestamp ||
+            center != ctx->center_freq || output_rate != ctx->sample_rate ) {
+        flags |= EXT_CTX_FLAG_DISCONTINUITY ;
+    }
+    ctx->center_freq = center ;
+    ctx->sample_rate = output_rate ;
+    ctx->hw_sample_rate = hw_rate ;
+    ctx->timestamp = timestamp ;
+    ctx->flags = flags ;
+    __atomic_store_n( &dev->push_next_timestamp, timestamp != 0 ? timestamp + count : 0, __ATOMIC_RELAXED );
+}
+
+// channelizer output : copied to a pool block, channel after channel, stamped with the input sample
+// its first sample lines up with
+static void emit_channels( void *ctx, TYPECPX *block, int block_len, int channels, uint64_t position ) {
+    struct t_rx_device* dev = (struct t_rx_device*)ctx ;
+    unsigned int decim = dev->channelizer->decim ;
+    uint64_t timestamp = dev->channelizer_base != 0 ? dev->channelizer_base + position : 0 ;
+
+    set_block_context( dev, timestamp, block_len * decim, dev->channelizer_rate / decim );
+    TYPECPX *samples = (TYPECPX*)sample_pool_acquire( dev->pool );
+    if( samples == NULL ) {
+        return ;
+    }
+    memcpy( samples, block, block_len * channels * sizeof(TYPECPX));
+    deliver_block( dev, samples, block_len, channels, &dev->ext_context );
+}
+
+/**
+ * @brief channelize_block feeds the channelizer, built again for a new hardware rate
+ * @param dev
+ * @param samples
+ * @param count
+ * @param timestamp of the first sample, 0 if unknown
+ */
+static void channelize_block( struct t_rx_device* dev, TYPECPX *samples, int count, uint64_t timestamp ) {
+    unsigned int rate = __atomic_load_n( &dev->current_sample_rate, __ATOMIC_RELAXED );
+
+    if( rate != dev->channelizer_rate ) {
+        struct t_device_config *cfg = &dev->config ;
+        channelizer_destroy( dev->channelizer );
+        dev->channelizer = channelizer_create( cfg->channelizer_fft_size, rate, cfg->channel_count,
+                                               cfg->channel_offset_hz, cfg->channel_bandwidth_hz,
+                                               dev->geometry.push_samples, dev->pool->block_samples,
+                                               emit_channels, dev );
+        dev->channelizer_rate = rate ;
+
+        char msg[256] ;
+        if( dev->channelizer == NULL ) {
+            snprintf( msg, sizeof(msg), "channelizer: settings do not fit %u Hz, no output", rate );
+            log( (int)(dev - rx), 0, msg );
+        } else {
+            for( int c=0 ; c < cfg->channel_count ; c++ ) {
+                snprintf( msg, sizeof(msg), "channelizer: channel %d at %.0f Hz, %.0f Hz wide, %u Hz output",
+                          c, channelizer_offset_hz( dev->channelizer, c, rate ), cfg->channel_bandwidth_hz[c],
+                          rate / dev->channelizer->decim );
+                log( (int)(dev - rx), 0, msg );
+            }
+        }
+    }
+    if( dev->channelizer != NULL ) {
+        // emit_channels() stamps its blocks from their input position, exact while the input has no gap
+        dev->channelizer_base = timestamp != 0 ? timestamp - dev->channelizer->consumed : 0 ;
+        channelizer_process( dev->channelizer, samples, count );
+    }
+}
+
+/**
+ * @brief mix_block brings the tuned frequency to 0 Hz in offset tuning mode
+ * @param dev
+ * @param samples
+ * @param count
+ */
+static void mix_block( struct t_rx_device* dev, TYPECPX *samples, int count ) {
+    int64_t shift = __atomic_load_n( &dev->nco_request_hz, __ATOMIC_ACQUIRE );
+    unsigned int rate = __atomic_load_n( &dev->current_sample_rate, __ATOMIC_RELAXED );
+
+    if( shift != dev->nco_shift_hz || rate != dev->nco_rate ) {
+        // only the step changes, the phase carries over
+        dev->nco.step = rate > 0 ? -2*M_PI * (double)shift / rate : 0 ;
+        dev->nco_shift_hz = shift ;
+        dev->nco_rate = rate ;
+    }
+    if( shift != 0 ) {
+        (*dsp_mix)( samples, count, &dev->nco );
+    }
+}
+
+/**
+ * @brief resample_block decimates the block in place when the current rate comes from the resampler
+ * @param dev
+ * @param samples
+ * @param count
+ * @return the number of samples left in the block
+ */
+static int resample_block( struct t_rx_device* dev, TYPECPX *samples, int count ) {
+    uint64_t ratio = __atomic_load_n( &dev->resampler_request, __ATOMIC_ACQUIRE );
+
+    if( ratio != dev->resampler_ratio ) {
+        // rate changed : new filter, the history of the old rate is dropped
+        resampler_destroy( dev->resampler );
+        dev->resampler = NULL ;
+        if( ratio != 0 ) {
+            dev->resampler = resampler_create( (unsigned int)(ratio >> 32), (unsigned int)(ratio & 0xFFFFFFFF),
+                                               dev->pool->block_samples );
+            if( dev->resampler == NULL ) {
+                fprintf( stderr, "%s cannot create resampler\n", __func__ );
+            }
+        }
+        dev->resampler_ratio = ratio ;
+    }
+    if( dev->resampler == NULL ) {
+        return( count );
+    }
+    return( resampler_process( dev->resampler, samples, count, samples ));
+}
+
+/**
+ * @brief push_block passes a block of converted samples to SDRNode and gives it back to the pool
+ *        if the callback did not keep it
+ * @param dev
+ * @param samples
+ * @param count
+ * @param timestamp hardware timestamp of the first sample, 0 if unknown
+ */
+static void push_block( struct t_rx_device* dev, TYPECPX *samples, int count, uint64_t timestamp ) {
+    mix_block( dev, samples, count );
+    if( dev->config.channel_count > 0 ) {
+        channelize_block( dev, samples, count, timestamp );
+        sample_pool_recycle( dev->pool, (float *)samples );
+        return ;
+    }
+    int input = count ;
+    count = resample_block( dev, samples, count );
+    unsigned int rate = __atomic_load_n( &dev->current_sample_rate, __ATOMIC_RELAXED );
+    if( dev->resampler != NULL ) {
+        rate = (unsigned int)((uint64_t)rate * dev->resampler->interp / dev->resampler->decim) ;
+    }
+    set_block_context( dev, timestamp, input, rate );
+    if( count <= 0 ) {
+        sample_pool_recycle( dev->pool, (float *)samples );
+        return ;
+    }
+    deliver_block( dev, samples, count, 1, &dev->ext_context );
+}
+
+/**
+ * @brief flush_partial pushes the block and commits the ring slot being filled by the stream callback
+ * @param dev
+ */
+static void flush_partial( struct t_rx_device* dev ) {
+    if( dev->cur_block != NULL ) {
+        push_block( dev, dev->cur_block, dev->cur_fill, dev->cur_timestamp );
+        dev->cur_block = NULL ;
+    }
+    if( dev->cur_slot != NULL ) {
+        stream_ring_commit( dev->ring );
+        dev->cur_slot = NULL ;
+    }
+}
+
+/**
+ * @brief stream_to_ring copies the payload of one USB message into the ring, the DSP thread does the conversion
+ * @param dev
+ * @param payload
+ * @param count number of IQ samples
+ * @param timestamp of the first sample of the payload
+ */
+static void stream_to_ring( struct t_rx_device* dev, const int16_t *payload, unsigned int count, uint64_t timestamp ) {
+    struct t_stream_ring *ring = dev->ring ;
+
+    while( count > 0 ) {
+        if( dev->cur_slot == NULL ) {
+            dev->cur_slot = stream_ring_write_slot( ring );
+            if( dev->cur_slot == NULL ) {
+                stream_ring_drop( ring, count );
+                return ;
+            }
+            dev->cur_slot->count = 0 ;
+            dev->cur_slot->timestamp = timestamp ;
+        }
+        unsigned int n = dev->geometry.push_samples - dev->cur_slot->count ;
+        if( n > count ) n = count ;
+
+        memcpy( dev->cur_slot->iq + 2*dev->cur_slot->count, payload, n * 2 * sizeof(int16_t));
+        payload += 2*n ;
+        count -= n ;
+        timestamp += n ;
+        dev->cur_slot->count += n ;
+
+        if( dev->cur_slot->count == dev->geometry.push_samples ) {
+            stream_ring_commit( ring );
+            dev->cur_slot = NULL ;
+        }
+    }
+}
+
+/**
+ * @brief stream_callback called by libbladeRF for each USB transfer in RX_ENGINE_STREAM mode.
+ *        Samples are converted directly from the transfer buffer into the pool blocks, skipping the
+ *        copy done by the sync interface and its worker thread
+ * @return the buffer to submit for the next transfer, or BLADERF_STREAM_SHUTDOWN
+ */
+static void *stream_callback( struct bladerf *, struct bladerf_stream *,
+                              struct bladerf_metadata *, void *samples, size_t num_samples,
+                              void *user_data ) {
+    struct t_rx_device* dev = (struct t_rx_device*)user_data ;
+    uint8_t *msg = (uint8_t *)samples ;
+    size_t bytes = num_samples * 2 * sizeof(int16_t) ;
+    unsigned int samples_per_msg = (dev->msg_size - METADATA_HEADER_SIZE) / (2 * sizeof(int16_t)) ;
+
+    if( dev->acq_stop ) {
+        return( BLADERF_STREAM_SHUTDOWN );
+    }
+    // the sample rate changed : the push size switches here, at a block boundary
+    struct t_stream_geometry g ;
+    if( takeGeometry( dev, &g )) {
+        flush_partial( dev );
+        dev->geometry = g ;
+    }
+
+    if( num_samples < dev->stream_geometry.buffer_size ) {
+        rx_stats_short( &dev->stats );
+    }
+    for( size_t off = 0 ; off + dev->msg_size <= bytes ; off += dev->msg_size ) {
+        const int16_t *payload = (const int16_t *)(msg + off + METADATA_HEADER_SIZE) ;
+        unsigned int left = samples_per_msg ;
+
+        // message header : 32 bits reserved, 64 bits timestamp, 32 bits flags, little endian like the host
+        uint64_t timestamp ;
+        memcpy( &timestamp, msg + off + 4, sizeof(timestamp));
+        rx_stats_received( &dev->stats, timestamp, samples_per_msg );
+
+        if( dev->ring != NULL ) {
+            stream_to_ring( dev, payload, left, timestamp );
+            continue ;
+        }
+        while( left > 0 ) {
+            if( dev->cur_block == NULL ) {
+                dev->cur_block = (TYPECPX*)sample_pool_acquire( dev->pool );
+                dev->cur_fill = 0 ;
+                dev->cur_timestamp = timestamp + (samples_per_msg - left) ;
+                if( dev->cur_block == NULL ) {
+                    return( samples ); // out of memory, drop this transfer
+                }
+            }
+            unsigned int n = dev->geometry.push_samples - dev->cur_fill ;
+            if( n > left ) n = left ;
+
+            (*dsp_convert_dc)( payload, dev->cur_block + dev->cur_fill, n, &dev->dc, dev->config.dc_alpha );
+            payload += 2*n ;
+            left -= n ;
+            dev->cur_fill += n ;
+
+            if( dev->cur_fill == dev->geometry.push_samples ) {
+                push_block( dev, dev->cur_block, dev->cur_fill, dev->cur_timestamp );
+                dev->cur_block = NULL ;
+            }
+        }
+    }
+    if( usbGeometryChanged( &dev->geometry, &dev->stream_geometry )) {
+        // the acquisition thread creates a stream with the new buffers and restarts
+        flush_partial( dev );
+        return( BLADERF_STREAM_SHUTDOWN );
+    }
+    // this buffer has been fully consumed, resubmit it
+    return( samples );
+}
+
+/**
+ * @brief configure_stream_engine allocates the libbladeRF stream used by RX_ENGINE_STREAM
+ * @param dev
+ * @return 0 or a libbladeRF error code
+ */
+static int configure_stream_engine( struct t_rx_device* dev ) {
+    int rc ;
+
+    // FPGA messages are 2048 bytes on USB 3.0, 1024 bytes on USB 2.0
+    dev->msg_size = bladerf_device_speed( dev->bladerf_device ) == BLADERF_DEVICE_SPEED_SUPER ? 2048 : 1024 ;
+
+    rc = bladerf_init_stream( &dev->stream, dev->bladerf_device, stream_callback,
+                              &dev->stream_buffers,
+                              dev->geometry.num_buffers,
+                              BLADERF_FORMAT_SC16_Q11_META,
+                              dev->geometry.buffer_size,
+                              dev->geometry.num_transfers,
+                              dev );
     if( rc != 0 ) {
-        goto cmd_calibrate_err;
+        fprintf( stderr, "%s bladerf_init_stream failed: %s\n", __func__, bladerf_strerror(rc));
+        return( rc );
+    }
+    dev->stream_geometry = dev->geometry ;
+    // first touch from this (placed) thread so the pages land on its NUMA node
+    for( unsigned int i=0 ; i < dev->geometry.num_buffers ; i++ ) {
+        memset( dev->stream_buffers[i], 0, dev->geometry.buffer_size * 2 * sizeof(int16_t));
+    }
+    return( bladerf_set_stream_timeout( dev->bladerf_device, BLADERF_MODULE_RX, dev->geometry.timeout_ms ));
+}
+
+/**
+ * @brief configure_sync_engine (re)configures the sync interface used by RX_ENGINE_SYNC with the current geometry
+ * @param dev
+ * @return 0 or a libbladeRF error code
+ */
+static int configure_sync_engine( struct t_rx_device* dev ) {
+    struct t_placement_saved saved ;
+    int rc ;
+
+    // the sync worker thread is created here and inherits our affinity and scheduling : switch to
+    // its placement, then back to ours (an empty acquisition placement would not undo the switch)
+    placement_save_self( &saved );
+    applyPlacement( dev, PLACEMENT_THREAD_SYNC_WORKER );
+    /* Configure the device's RX module for use with the sync interface.
+     * SC16 Q11 samples *with* metadata are used. */
+    rc = bladerf_sync_config( dev->bladerf_device,
+                              BLADERF_MODULE_RX,
+                              BLADERF_FORMAT_SC16_Q11_META,
+                              dev->geometry.num_buffers,
+                              dev->geometry.buffer_size,
+                              dev->geometry.num_transfers,
+                              dev->geometry.timeout_ms);
+    placement_restore_self( &saved );
+    if( rc == 0 ) {
+        rc = bladerf_set_sync_rx_overrun_wait( dev->bladerf_device, dev->config.overrun_wait_us );
+    }
+    if( rc == 0 ) {
+        rc = bladerf_set_sync_rx_wakeups( dev->bladerf_device, dev->config.wake_batch, dev->config.spin_us );
+    }
+    return( rc );
+}
+
+/**
+ * @brief prefault_buffers writes the pool blocks and ring slots once from the placed acquisition thread,
+ *        so that with the first-touch policy their pages are allocated on its NUMA node
+ * @param dev
+ */
+static void prefault_buffers( struct t_rx_device* dev ) {
+    if( dev->config.placement.numa_node < 0 )
+        return ;
+    for( unsigned int i=0 ; i < dev->pool->block_count ; i++ ) {
+        if( dev->pool->blocks[i] != NULL ) {
+            memset( dev->pool->blocks[i], 0, dev->pool->block_samples * 2 * sizeof(float));
+        }
+    }
+    if( dev->ring != NULL ) {
+        for( unsigned int i=0 ; i < dev->ring->depth ; i++ ) {
+            memset( dev->ring->slots[i].iq, 0, dev->ring->slot_samples * 2 * sizeof(int16_t));
+        }
+    }
+}
+
+/**
+ * @brief calibrateDc restores the LMS DC calibration from the cache when a fresh entry exists for this
+ *        board and FPGA, otherwise runs the full calibration and stores the result
+ * @param dev
+ * @return 0 or a libbladeRF error code
+ */
+static int calibrateDc( struct t_rx_device *dev ) {
+    bladerf *bladerf_device = dev->bladerf_device ;
+    struct bladerf_lms_dc_cals cals ;
+    struct bladerf_version fpga ;
+    struct timespec t0 ;
+    char msg[256] ;
+    int rc ;
+
+    clock_gettime( CLOCK_MONOTONIC, &t0 );
+    const char *fpga_version = "unknown" ;
+    if( bladerf_fpga_version( bladerf_device, &fpga ) == 0 && fpga.describe != NULL ) {
+        fpga_version = fpga.describe ;
     }
 
+    if( dc_cal_cache_load( dev->config.dc_cal_dir, dev->device_serial_number, fpga_version,
+                           dev->config.dc_cal_max_age_s, &cals ) == 0 ) {
+        rc = bladerf_lms_set_dc_cals( bladerf_device, &cals );
+        if( rc == 0 ) {
+            snprintf( msg, sizeof(msg), "DC calibration restored from cache in %.1f ms", elapsedMs( &t0 ));
+            log( (int)(dev - rx), 0, msg );
+            return(0);
+        }
+        fprintf( stderr,"doCalibrate failed bladerf_lms_set_dc_cals: %s\n",  bladerf_strerror(rc));
+    }
 
     // Calibrate LPF Tuning Module
     rc = bladerf_calibrate_dc( bladerf_device, BLADERF_DC_CAL_LPF_TUNING);
     if (rc != 0) {
         fprintf( stderr,"doCalibrate failed bladerf_calibrate_dc: %s\n",  bladerf_strerror(rc));
-        goto cmd_calibrate_err;
+        return( rc );
     }
 
     // Calibrate TX LPF Filter
     rc = bladerf_calibrate_dc( bladerf_device, BLADERF_DC_CAL_TX_LPF);
     if (rc != 0) {
         fprintf( stderr,"doCalibrate failed bladerf_calibrate_dc: %s\n",  bladerf_strerror(rc));
-        goto cmd_calibrate_err;
+        return( rc );
     }
 
     // Calibrate RX LPF Filter
     rc = bladerf_calibrate_dc( bladerf_device, BLADERF_DC_CAL_RX_LPF);
     if (rc != 0) {
         fprintf( stderr,"doCalibrate failed bladerf_calibrate_dc: %s\n",  bladerf_strerror(rc));
-        goto cmd_calibrate_err;
+        return( rc );
     }
 
     // Calibrate RX VGA2
     rc = bladerf_calibrate_dc( bladerf_device, BLADERF_DC_CAL_RXVGA2);
     if (rc != 0) {
         fprintf( stderr, "doCalibrate failed bladerf_calibrate_dc: %s\n",  bladerf_strerror(rc));
+        return( rc );
+    }
+
+    if( dev->config.dc_cal_dir[0] != 0 ) {
+        rc = bladerf_lms_get_dc_cals( bladerf_device, &cals );
+        if( rc != 0 || dc_cal_cache_store( dev->config.dc_cal_dir, dev->device_serial_number, fpga_version, &cals ) != 0 ) {
+            fprintf( stderr, "%s : cannot save the DC calibration of %s in %s\n", __func__,
+                     dev->device_serial_number, dev->config.dc_cal_dir );
+        }
+    }
+    snprintf( msg, sizeof(msg), "DC calibration done in %.1f ms", elapsedMs( &t0 ));
+    log( (int)(dev - rx), 0, msg );
+    return(0);
+}
+
+/**
+ * @brief sweepRestart forgets the queued hops and the dwell being filled, the schedule starts again
+ *        from the next read
+ * @param dev
+ */
+static void sweepRestart( struct t_rx_device *dev ) {
+    if( dev->sweep == NULL )
+        return ;
+    if( dev->sweep->queued > 0 ) {
+        bladerf_cancel_scheduled_retunes( dev->bladerf_device, BLADERF_MODULE_RX );
+    }
+    sweep_restart( dev->sweep );
+    if( dev->sweep_block != NULL ) {
+        sample_pool_recycle( dev->pool, (float *)dev->sweep_block );
+        dev->sweep_block = NULL ;
+    }
+}
+
+/**
+ * @brief sweepStop leaves the sweep mode and tunes back to the frequency set by setRxCenterFreq()
+ * @param dev
+ */
+static void sweepStop( struct t_rx_device *dev ) {
+    char msg[256];
+
+    if( dev->sweep == NULL )
+        return ;
+    sweepRestart( dev );
+    snprintf( msg, sizeof(msg), "sweep: dwells=%llu late=%llu incomplete=%llu",
+              (unsigned long long)dev->sweep->dwells_pushed, (unsigned long long)dev->sweep->dwells_late,
+              (unsigned long long)dev->sweep->dwells_incomplete );
+    log( (int)(dev - rx), 0, msg );
+    sweep_free( dev->sweep );
+    dev->sweep = NULL ;
+    memset( &dev->dc, 0, sizeof(dev->dc)); // streaming resumes on another frequency
+    dev->lo_frq_hz = 0 ; // the LO is where the last hop left it, tuneRx must move it
+    tuneRx( dev, __atomic_load_n( &dev->center_frq_hz, __ATOMIC_ACQUIRE ));
+}
+
+/**
+ * @brief takeSweep called by the acquisition thread between two reads, switches to the plan given by
+ *        startSweep() or stopSweep() if it changed. Frequencies missing from the quick tune cache are
+ *        tuned once here, so that every hop of the sweep is a quick one.
+ *        sweepCollect() runs the DSP stage on this thread : with the pipeline, the plan is only installed
+ *        once the DSP thread has pushed every queued block
+ * @param dev
+ */
+static void takeSweep( struct t_rx_device *dev ) {
+    struct bladerf_quick_tune values ;
+
+    if( __atomic_load_n( &dev->sweep_serial, __ATOMIC_ACQUIRE ) == dev->sweep_applied ) {
+        return ;
+    }
+    pthread_mutex_lock( &dev->sweep_lock );
+    struct t_sweep *next = dev->sweep_request ;
+    dev->sweep_request = NULL ;
+    dev->sweep_applied = dev->sweep_serial ;
+    pthread_mutex_unlock( &dev->sweep_lock );
+
+    sweepStop( dev );
+    if( next != NULL && dev->config.quick_tune ) {
+        for( int i=0 ; i < next->plan.count ; i++ ) {
+            if( !tune_cache_find( &dev->tune_cache, (unsigned int)next->plan.frequency[i], &values )) {
+                moveLo( dev, next->plan.frequency[i], false );
+            }
+        }
+    }
+    if( next != NULL && dev->ring != NULL ) {
+        while( !stream_ring_drained( dev->ring )) {
+            usleep( 100 );
+        }
+    }
+    dev->sweep = next ;
+}
+
+/**
+ * @brief sweepSchedule queues the next hops in the FPGA, each one after the samples libbladeRF
+ *        already buffered plus retune_lead_us
+ * @param dev
+ * @param received timestamp following the last read
+ */
+static void sweepSchedule( struct t_rx_device *dev, uint64_t received ) {
+    struct t_sweep *s = dev->sweep ;
+    struct bladerf_quick_tune values ;
+    struct t_dwell *d ;
+
+    uint64_t not_before = received + (uint64_t)dev->geometry.num_buffers * dev->geometry.buffer_size +
+            (uint64_t)dev->current_sample_rate * dev->config.retune_lead_us / 1000000 ;
+    if( s->next_hop == 0 ) {
+        sweep_start( s, not_before, dev->current_sample_rate );
+    }
+    while( sweep_next_hop( s, not_before, &d )) {
+        bool quick = dev->config.quick_tune && tune_cache_find( &dev->tune_cache, (unsigned int)d->frequency, &values );
+        int rc = bladerf_schedule_retune( dev->bladerf_device, BLADERF_MODULE_RX, d->hop,
+                                          (unsigned int)d->frequency, quick ? &values : NULL );
+        if( rc == BLADERF_ERR_QUEUE_FULL ) {
+            sweep_cancel_hop( s ); // try again after the next read
+            break ;
+        }
+        if( rc != 0 ) {
+            fprintf( stderr, "%s bladerf_schedule_retune failed: %s, sweep stopped\n", __func__, bladerf_strerror(rc));
+            sweepStop( dev );
+            break ;
+        }
+        dev->scheduled_retunes++ ;
+    }
+}
+
+/**
+ * @brief sweepCollect keeps the samples of a read falling in the queued dwells and pushes each dwell once
+ *        complete, the settling samples and those between dwells are dropped
+ * @param dev
+ * @param iq raw samples of the read
+ * @param timestamp of the first sample
+ * @param count
+ */
+static void sweepCollect( struct t_rx_device *dev, const int16_t *iq, uint64_t timestamp, unsigned int count ) {
+    struct t_sweep *s = dev->sweep ;
+    uint64_t read_end = timestamp + count ;
+    struct t_dwell *d ;
+
+    while( (d = sweep_front( s )) != NULL ) {
+        uint64_t begin = sweep_dwell_begin( s, d );
+        uint64_t end = begin + s->plan.dwell_samples ;
+        if( begin >= read_end ) {
+            break ; // not there yet
+        }
+        if( end > timestamp ) {
+            uint64_t from = begin > timestamp ? begin : timestamp ;
+            uint64_t to = end < read_end ? end : read_end ;
+            if( dev->sweep_block == NULL ) {
+                dev->sweep_block = (TYPECPX*)sample_pool_acquire( dev->pool );
+            }
+            if( dev->sweep_block != NULL ) {
+                if( d->filled == 0 ) {
+                    // each dwell is on its own frequency : no DC estimate carried over
+                    memset( &dev->sweep_dc, 0, sizeof(dev->sweep_dc));
+                }
+                (*dsp_convert_dc)( iq + 2*(from - timestamp), dev->sweep_block + (from - begin), (int)(to - from),
+                                   &dev->sweep_dc, dev->config.dc_alpha );
+                d->filled += (unsigned int)(to - from) ;
+            }
+        }
+        if( end > read_end ) {
+            break ; // the next read completes it
+        }
+        if( dev->sweep_block != NULL && d->filled == s->plan.dwell_samples ) {
+            struct ext_Context *ctx = &dev->sweep_context ;
+            ctx->ctx_version = EXT_CONTEXT_VERSION ;
+            ctx->center_freq = d->frequency ;
+            ctx->sample_rate = dev->current_sample_rate ;
+            ctx->hw_sample_rate = dev->current_sample_rate ;
+            ctx->timestamp = begin ;
+            ctx->flags = EXT_CTX_FLAG_TIMESTAMP | EXT_CTX_FLAG_DISCONTINUITY | EXT_CTX_FLAG_SWEEP ;
+            deliver_block( dev, dev->sweep_block, s->plan.dwell_samples, 1, ctx );
+            s->dwells_pushed++ ;
+        } else {
+            if( dev->sweep_block != NULL ) {
+                sample_pool_recycle( dev->pool, (float *)dev->sweep_block );
+            }
+            s->dwells_incomplete++ ;
+        }
+        dev->sweep_block = NULL ;
+        sweep_pop( s );
+    }
+}
+
+/**
+ * @brief standby keeps reading and dropping samples after finalizeRXEngine(), so that the libbladeRF sync
+ *        stream stays primed and its buffers hold fresh samples when prepareRXEngine() is called again
+ * @param dev
+ * @param buffer scratch buffer for the dropped samples
+ * @return true if prepareRXEngine() was called before the idle timeout, its semaphore post is consumed
+ */
+static bool standby( struct t_rx_device *dev, int16_t *buffer ) {
+    struct bladerf_metadata meta ;
+    struct timespec t0 ;
+
+    clock_gettime( CLOCK_MONOTONIC, &t0 );
+    while( elapsedMs( &t0 ) < dev->config.standby_timeout_ms ) {
+        if( sem_trywait( &dev->mutex ) == 0 ) {
+            return( true );
+        }
+        memset( &meta, 0, sizeof(meta));
+        meta.flags = BLADERF_META_FLAG_RX_NOW ;
+        int rc = bladerf_sync_rx( dev->bladerf_device, buffer, dev->geometry.push_samples, &meta, dev->geometry.timeout_ms );
+        if( rc != 0 ) {
+            fprintf( stderr, "%s bladerf_sync_rx failed: %s\n", __func__, bladerf_strerror(rc));
+            return( false );
+        }
+    }
+    return( false );
+}
+
+// gives the lent buffer back to libbladeRF, what was not converted is dropped
+static void releaseLent( struct t_rx_device *dev ) {
+    if( dev->lent.data != NULL ) {
+        bladerf_sync_rx_release( dev->bladerf_device, &dev->lent );
+        dev->lent.data = NULL ;
+    }
+}
+
+/**
+ * @brief readLent converts the next block straight from the sync buffers, saving the copy made by
+ *        bladerf_sync_rx(). Like bladerf_sync_rx(), the block ends early at a discontinuity
+ * @param dev
+ * @param samples pool block, NULL to drop the samples
+ * @param timestamp of the first sample
+ * @return number of samples, or a libbladeRF error code
+ */
+static int readLent( struct t_rx_device *dev, TYPECPX *samples, uint64_t *timestamp ) {
+    struct bladerf_sync_rx_buffer *b = &dev->lent ;
+    unsigned int wanted = dev->geometry.push_samples ;
+    unsigned int count = 0 ;
+
+    while( count < wanted ) {
+        if( b->data == NULL ) {
+            int rc = bladerf_sync_rx_acquire( dev->bladerf_device, b, dev->geometry.timeout_ms );
+            if( rc != 0 ) {
+                return( count > 0 ? (int)count : rc );
+            }
+            dev->lent_msg = 0 ;
+            dev->lent_off = 0 ;
+            if( count > 0 && b->timestamp != *timestamp + count ) {
+                break ; // this buffer starts the next block
+            }
+        }
+        if( count == 0 ) {
+            *timestamp = b->timestamps[dev->lent_msg] + dev->lent_off ;
+        }
+        unsigned int n = b->samples_per_msg - dev->lent_off ;
+        if( n > wanted - count ) {
+            n = wanted - count ;
+        }
+        if( samples != NULL ) {
+            const uint8_t *msg = (const uint8_t *)b->data + (size_t)dev->lent_msg * b->msg_size + b->header_size ;
+            (*dsp_convert_dc)( (const int16_t *)msg + 2*dev->lent_off, samples + count, n, &dev->dc, dev->config.dc_alpha );
+        }
+        count += n ;
+        dev->lent_off += n ;
+        if( dev->lent_off == b->samples_per_msg ) {
+            dev->lent_msg++ ;
+            dev->lent_off = 0 ;
+        }
+        if( dev->lent_msg == b->num_messages ) {
+            bool overrun = (b->status & BLADERF_META_STATUS_OVERRUN) != 0 ;
+            releaseLent( dev );
+            if( overrun ) {
+                break ; // the next samples do not follow
+            }
+        }
+    }
+    return( (int)count );
+}
+
+/**
+ * @brief acquisition_thread This function is locked by the mutex and waits before starting the acquisition in asynch mode
+ * @param params
+ * @return
+ */
+void* acquisition_thread( void *params ) {
+    int rc ;
+    int16_t *ptr;
+    struct bladerf_metadata meta;
+    bool warm ; // resumed from standby : RX module still enabled and sync stream primed
+    struct t_rx_device* dev = (struct t_rx_device*)params ;
+    bladerf *bladerf_device = dev->bladerf_device ;
+
+    applyPlacement( dev, PLACEMENT_THREAD_ACQUISITION );
+    prefault_buffers( dev );
+
+    // calibration procedure
+    rc = bladerf_enable_module(  bladerf_device, BLADERF_MODULE_TX, true);
+    if( rc != 0 ) {
+        goto cmd_calibrate_err;
+    }
+
+    // LMS DC calibration, from the cache when possible
+    rc = calibrateDc( dev );
+    if (rc != 0) {
         goto cmd_calibrate_err;
     }
     //-------------------------
@@ -756,15 +2289,11 @@ void* acquisition_thread( void *params ) {
     }
 
     bladerf_set_lpf_mode( bladerf_device, BLADERF_MODULE_RX, BLADERF_LPF_NORMAL);
-    /* Configure the device's RX module for use with the sync interface.
-     * SC16 Q11 samples *with* metadata are used. */
-    rc = bladerf_sync_config( bladerf_device,
-                              BLADERF_MODULE_RX,
-                              BLADERF_FORMAT_SC16_Q11_META,
-                              DEFAULT_STREAM_BUFFERS,
-                              DEFAULT_STREAM_BUFFERSIZE,
-                              DEFAULT_STREAM_NUMTRANSFERS,
-                              DEFAULT_STREAM_TIMEOUT);
+    if( dev->config.rx_engine == RX_ENGINE_STREAM ) {
+        rc = configure_stream_engine( dev );
+    } else {
+        rc = configure_sync_engine( dev );
+    }
     if (rc != 0) {
         if( DEBUG_DRIVER ) {
             fprintf( stderr, "Error failed for configure %s\n", __func__);
@@ -772,65 +2301,211 @@ void* acquisition_thread( void *params ) {
         }
     }
 
-    ptr = (int16_t *)malloc(DEFAULT_STREAM_SAMPLES * 2 * sizeof(int16_t));
+    ptr = (int16_t *)malloc(dev->pool->block_samples * 2 * sizeof(int16_t));
     dev->running = false ;
+    dev->warm_starts = 0 ;
+    dev->lent.data = NULL ;
+    warm = false ;
     for( ; ; ) {
 
-        if( DEBUG_DRIVER ) fprintf(stderr,"- %s() thread waiting\n", __func__ );
-        if( DEBUG_DRIVER ) fflush(stderr);
+        if( !warm ) {
+            if( DEBUG_DRIVER ) fprintf(stderr,"- %s() thread waiting\n", __func__ );
+            if( DEBUG_DRIVER ) fflush(stderr);
 
-        sem_wait( &dev->mutex );
-        if( DEBUG_DRIVER ) fprintf(stderr,"+ %s() thread starting\n", __func__ );
+            sem_wait( &dev->mutex );
+        }
+        if( DEBUG_DRIVER ) fprintf(stderr,"+ %s() thread starting%s\n", __func__, warm ? " from standby" : "" );
 
-        dev->running = true ;
+        __atomic_store_n( &dev->hop_timestamp, 0, __ATOMIC_RELEASE ); // timestamps from a previous run
+        __atomic_store_n( &dev->running, true, __ATOMIC_SEQ_CST );
+        rx_stats_restart( &dev->stats );
         // We must always enable the RX module before attempting to RX samples
-        rc = bladerf_enable_module( bladerf_device, BLADERF_MODULE_RX, true);
-        if (rc != 0) {
-            if( DEBUG_DRIVER ) {
-                fprintf( stderr, "Error failed for bladerf_enable_module %s\n", __func__);
-                return(NULL);
+        if( !warm ) {
+            rc = bladerf_enable_module( bladerf_device, BLADERF_MODULE_RX, true);
+            if (rc != 0) {
+                if( DEBUG_DRIVER ) {
+                    fprintf( stderr, "Error failed for bladerf_enable_module %s\n", __func__);
+                    return(NULL);
+                }
             }
+        } else {
+            dev->warm_starts++ ;
         }
-        while( !dev->acq_stop ) {
-            /* Perform a read immediately, and have the bladerf_sync_rx function
-             * provide the timestamp of the read samples */
-            memset(&meta, 0, sizeof(meta));
-            meta.flags = BLADERF_META_FLAG_RX_NOW;
-            rc = bladerf_sync_rx( bladerf_device, ptr, DEFAULT_STREAM_SAMPLES, &meta, 5000);
-            if( rc == 0 ) {
-                // we have samples
-                TYPECPX *samples = (TYPECPX*)malloc( meta.actual_count * sizeof(TYPECPX));
-                for( int i=0 ; i < meta.actual_count ; i++ ) {
-                    int j=2*i;
-    #ifndef _WINDOWS
-                    I = (float)( le16toh( ptr[ j   ] ))* 1.0/2048.0 ;
-                    Q = (float)( le16toh( ptr[ j+1 ] ))* 1.0/2048.0 ;
-    #else
-                    I = (float)( ptr[ j   ]) * 1.0/2048.0 ;
-                    Q = (float)( ptr[ j+1 ]) * 1.0/2048.0 ;
-    #endif
-                    // DC
-                    // y[n] = x[n] - x[n-1] + alpha * y[n-1]
-                    // see http://peabody.sapp.org/class/dmp2/lab/dcblock/
-                    tmp.re = I - dev->xn_1.re + ALPHA_DC * dev->yn_1.re ;
-                    tmp.im = Q - dev->xn_1.im + ALPHA_DC * dev->yn_1.im ;
-
-                    dev->xn_1.re = I ;
-                    dev->xn_1.im = Q ;
-                    dev->yn_1.re = tmp.re ;
-                    dev->yn_1.im = tmp.im ;
-
-                    samples[i] = tmp ;
+        warm = false ;
+        if( dev->config.rx_engine == RX_ENGINE_STREAM ) {
+            for( ; ; ) {
+                // a rate change may need a stream with other buffers
+                struct t_stream_geometry g ;
+                if( takeGeometry( dev, &g )) {
+                    dev->geometry = g ;
+                }
+                if( usbGeometryChanged( &dev->geometry, &dev->stream_geometry )) {
+                    bladerf_deinit_stream( dev->stream );
+                    dev->stream = NULL ;
+                    rc = configure_stream_engine( dev );
+                    if( rc != 0 ) {
+                        break ;
+                    }
+                }
+                // returns when the callback sees acq_stop or a new geometry
+                rx_stats_restart( &dev->stats );
+                rc = bladerf_stream( dev->stream, BLADERF_MODULE_RX );
+                if( rc != 0 ) {
+                    fprintf( stderr, "%s bladerf_stream failed: %s\n", __func__, bladerf_strerror(rc));
+                }
+                if( dev->cur_block != NULL ) {
+                    sample_pool_recycle( dev->pool, (float *)dev->cur_block );
+                    dev->cur_block = NULL ;
+                }
+                if( dev->cur_slot != NULL ) {
+                    stream_ring_commit( dev->ring ); // flush the partial slot
+                    dev->cur_slot = NULL ;
+                }
+                if( dev->acq_stop || rc != 0 ) {
+                    break ;
+                }
+            }
+        } else {
+            while( !dev->acq_stop ) {
+                // commands queued by SDRNode take effect between two reads
+                applyControl( dev );
+                takeSweep( dev );
+                // a rate change may need new sync buffers, switch between two reads
+                struct t_stream_geometry g ;
+                if( takeGeometry( dev, &g )) {
+                    bool reconfigure = usbGeometryChanged( &dev->geometry, &g );
+                    dev->geometry = g ;
+                    if( reconfigure ) {
+                        releaseLent( dev ); // its buffer goes away with the sync interface
+                        bladerf_enable_module( bladerf_device, BLADERF_MODULE_RX, false );
+                        rc = configure_sync_engine( dev );
+                        if( rc != 0 ) {
+                            fprintf( stderr, "%s bladerf_sync_config failed: %s\n", __func__, bladerf_strerror(rc));
+                            break ;
+                        }
+                        bladerf_enable_module( bladerf_device, BLADERF_MODULE_RX, true );
+                        rx_stats_restart( &dev->stats );
+                        sweepRestart( dev );
+                    }
+                }
+                if( dev->ring == NULL && dev->sweep == NULL ) {
+                    // no pipeline : convert in place from the sync buffers
+                    uint64_t timestamp = 0 ;
+                    TYPECPX *samples = (TYPECPX*)sample_pool_acquire( dev->pool );
+                    int count = readLent( dev, samples, &timestamp );
+                    rc = count < 0 ? count : 0 ;
+                    if( count > 0 ) {
+                        rx_stats_received( &dev->stats, timestamp, count );
+                        if( (unsigned int)count < dev->geometry.push_samples ) {
+                            rx_stats_short( &dev->stats );
+                        }
+                    }
+                    if( samples == NULL ) {
+                        continue ;
+                    }
+                    if( count <= 0 ) {
+                        sample_pool_recycle( dev->pool, (float *)samples );
+                        continue ;
+                    }
+                    push_block( dev, samples, count, timestamp );
+                    continue ;
+                }
+                releaseLent( dev ); // the other paths read with bladerf_sync_rx()
+                // with the pipeline, read directly into the next ring slot and let the DSP thread do the rest
+                struct t_ring_slot *slot = NULL ;
+                int16_t *dest = ptr ;
+                if( dev->ring != NULL && dev->sweep == NULL ) {
+                    slot = stream_ring_write_slot( dev->ring );
+                    if( slot != NULL ) {
+                        dest = slot->iq ;
+                    }
+                }
+                /* Perform a read immediately, and have the bladerf_sync_rx function
+                 * provide the timestamp of the read samples */
+                memset(&meta, 0, sizeof(meta));
+                meta.flags = BLADERF_META_FLAG_RX_NOW;
+                rc = bladerf_sync_rx( bladerf_device, dest, dev->geometry.push_samples, &meta, dev->geometry.timeout_ms);
+                if( rc == 0 ) {
+                    // libbladeRF flags BLADERF_META_STATUS_OVERRUN on the discontinuity the timestamps also show
+                    rx_stats_received( &dev->stats, meta.timestamp, meta.actual_count );
+                    if( meta.actual_count < dev->geometry.push_samples ) {
+                        rx_stats_short( &dev->stats );
+                    }
+                }
+                if( rc == 0 && dev->sweep != NULL ) {
+                    // sweeping : the samples go to the dwells only
+                    sweepCollect( dev, dest, meta.timestamp, meta.actual_count );
+                    sweepSchedule( dev, meta.timestamp + meta.actual_count );
+                    continue ;
                 }
-                // push samples to SDRNode callback function
-                // we only manage one channel per device
-                if( (*acqCbFunction)( dev->uuid, (float *)samples, meta.actual_count, 1, &dev->ext_context ) <= 0 ) {
-                      free(samples);
+                if( rc == 0 && dev->ring != NULL ) {
+                    if( slot == NULL ) {
+                        // DSP thread is late, ring is full : keep draining USB, drop this block
+                        stream_ring_drop( dev->ring, meta.actual_count );
+                        continue ;
+                    }
+                    slot->count = meta.actual_count ;
+                    slot->timestamp = meta.timestamp ;
+                    stream_ring_commit( dev->ring );
                 }
             }
+            releaseLent( dev );
+        }
+        __atomic_store_n( &dev->running, false, __ATOMIC_SEQ_CST );
+        sweepRestart( dev ); // hops of this run are meaningless for the next one
+        // a command queued while we were stopping saw the device running and left it to us
+        applyControl( dev );
+
+        char msg[256];
+        struct t_pool_stats *ps = &dev->pool->stats ;
+        snprintf( msg, sizeof(msg), "sample pool: acquired=%llu recycled=%llu released=%llu handed_off=%llu exhausted=%llu fallback_allocs=%llu rejected=%llu untracked=%llu",
+                  (unsigned long long)ps->acquired, (unsigned long long)ps->recycled,
+                  (unsigned long long)ps->released, (unsigned long long)ps->handed_off,
+                  (unsigned long long)ps->exhausted, (unsigned long long)ps->fallback_allocs,
+                  (unsigned long long)ps->rejected, (unsigned long long)ps->untracked );
+        log( (int)(dev - rx), 0, msg );
+        struct t_rx_stats *st = &dev->stats ;
+        snprintf( msg, sizeof(msg), "rx stats: received=%llu pushed=%llu overruns=%llu lost=%llu short=%llu push p50=%uus p99=%uus max=%lluus",
+                  (unsigned long long)st->samples_received, (unsigned long long)st->samples_pushed,
+                  (unsigned long long)st->overruns, (unsigned long long)st->samples_lost,
+                  (unsigned long long)st->short_transfers, rx_stats_latency_percentile( st, 50 ),
+                  rx_stats_latency_percentile( st, 99 ), (unsigned long long)st->latency_max_us );
+        log( (int)(dev - rx), 0, msg );
+        snprintf( msg, sizeof(msg), "tuning: lo=%llu nco=%llu quick=%llu scheduled=%llu cache hits=%llu misses=%llu",
+                  (unsigned long long)dev->lo_retunes, (unsigned long long)dev->nco_retunes,
+                  (unsigned long long)dev->quick_retunes, (unsigned long long)dev->scheduled_retunes,
+                  (unsigned long long)dev->tune_cache.hits, (unsigned long long)dev->tune_cache.misses );
+        log( (int)(dev - rx), 0, msg );
+        struct bladerf_sync_rx_stats ss ;
+        if( dev->config.rx_engine == RX_ENGINE_SYNC && bladerf_get_sync_rx_stats( bladerf_device, &ss ) == 0 ) {
+            snprintf( msg, sizeof(msg), "sync overruns: overruns=%llu absorbed=%llu buffers_dropped=%llu samples_lost=%llu",
+                      (unsigned long long)ss.overruns, (unsigned long long)ss.stalls_absorbed,
+                      (unsigned long long)ss.buffers_dropped, (unsigned long long)ss.samples_lost );
+            log( (int)(dev - rx), 0, msg );
+            snprintf( msg, sizeof(msg), "sync wakeups: sleeps=%llu wakeups=%llu spin_hits=%llu",
+                      (unsigned long long)ss.sleeps, (unsigned long long)ss.wakeups,
+                      (unsigned long long)ss.spin_hits );
+            log( (int)(dev - rx), 0, msg );
+        }
+        if( dev->ring != NULL ) {
+            struct t_ring_stats *rs = &dev->ring->stats ;
+            snprintf( msg, sizeof(msg), "rx ring: depth=%u high_water=%u committed=%llu overruns=%llu dropped_samples=%llu",
+                      dev->ring->depth, rs->high_water, (unsigned long long)rs->committed,
+                      (unsigned long long)rs->overruns, (unsigned long long)rs->dropped_samples );
+            log( (int)(dev - rx), 0, msg );
+        }
+
+        // standby until the next start or the idle timeout, then power down
+        if( dev->config.rx_engine == RX_ENGINE_SYNC && dev->config.standby_timeout_ms > 0 && rc == 0 ) {
+            warm = standby( dev, ptr );
+        }
+        if( !warm ) {
+            rc = bladerf_enable_module( bladerf_device, BLADERF_MODULE_RX, false);
+            if( dev->config.standby_timeout_ms > 0 ) {
+                snprintf( msg, sizeof(msg), "standby: RX disabled, warm starts=%llu", (unsigned long long)dev->warm_starts );
+                log( (int)(dev - rx), 0, msg );
+            }
         }
-        rc = bladerf_enable_module( bladerf_device, BLADERF_MODULE_RX, false);
-        dev->running = false ;
     }
     return(NULL);
 
@@ -840,3 +2515,31 @@ cmd_calibrate_err:
     return(NULL);
 }
 
+/**
+ * @brief dsp_thread second stage of the pipeline : converts the raw blocks queued by the receiving thread
+ *        and pushes them to SDRNode, so a slow callback does not stall the USB side
+ * @param params
+ * @return
+ */
+void* dsp_thread( void *params ) {
+    struct t_rx_device* dev = (struct t_rx_device*)params ;
+    struct t_stream_ring *ring = dev->ring ;
+
+    applyPlacement( dev, PLACEMENT_THREAD_DSP );
+    for( ; ; ) {
+        struct t_ring_slot *slot = stream_ring_read_slot( ring, 500 );
+        if( slot == NULL ) {
+            continue ;
+        }
+        TYPECPX *samples = (TYPECPX*)sample_pool_acquire( dev->pool );
+        if( samples != NULL ) {
+            (*dsp_convert_dc)( slot->iq, samples, slot->count, &dev->dc, dev->config.dc_alpha );
+        }
+        if( samples != NULL ) {
+            push_block( dev, samples, slot->count, slot->timestamp );
+        }
+        // released once pushed, so that a drained ring means this thread is idle (see takeSweep)
+        stream_ring_release( ring );
+    }
+    return(NULL);
+}
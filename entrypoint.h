@@ -40,10 +40,40 @@
  *  For more details on the following functions, please look at http://wiki.cloud-sdr.com/doku.php?id=documentation
  */
 
+// context given with each block of samples, filled for that block by the driver
+#define EXT_CONTEXT_VERSION (1)
+#define EXT_CTX_FLAG_TIMESTAMP     (1) // timestamp is valid
+#define EXT_CTX_FLAG_DISCONTINUITY (2) // block does not follow the previous one : samples lost, restart, retune or rate change
+#define EXT_CTX_FLAG_CONTROL       (4) // first block pushed after a frequency, gain or rate command was applied
+#define EXT_CTX_FLAG_SWEEP         (8) // one dwell of startSweep() : center_freq and timestamp are the dwell's
+
 struct ext_Context {
     long ctx_version ;
-    int64_t center_freq;
-    unsigned int sample_rate;
+    int64_t center_freq;        // in effect for this block
+    unsigned int sample_rate;   // of the pushed samples
+    // ctx_version >= 1
+    unsigned int flags ;
+    uint64_t timestamp ;        // hardware timestamp of the first sample that went into the block
+    unsigned int hw_sample_rate ; // timestamp ticks per second
+};
+
+// streaming counters of one device, see getStreamStats()
+struct t_stream_stats {
+    uint64_t samples_received ;     // from the USB side
+    uint64_t samples_pushed ;       // given to the push callback, all channels
+    uint64_t blocks_pushed ;
+    uint64_t overruns ;             // discontinuities in the sample timestamps
+    uint64_t samples_lost ;         // computed from the timestamp gaps
+    uint64_t short_transfers ;
+    uint64_t ring_overruns ;        // blocks dropped because the DSP thread was late
+    uint64_t ring_dropped_samples ;
+    uint64_t pool_exhausted ;       // blocks allocated outside the sample pool
+    unsigned int ring_depth ;       // 0 : no receive -> DSP ring
+    unsigned int ring_high_water ;
+    unsigned int push_latency_p50_us ; // push callback duration percentiles
+    unsigned int push_latency_p90_us ;
+    unsigned int push_latency_p99_us ;
+    unsigned int push_latency_max_us ;
 };
 
 // call this function to log something into the SDRNode central log file
@@ -99,15 +129,30 @@ extern "C" {
     LIBRARY_API int prepareRXEngine( int device_id );
     LIBRARY_API int finalizeRXEngine( int device_id );
 
+    // rate, frequency and gain changes are queued and never wait for the stream : while the sync engine
+    // runs they take effect between two reads, the getters report the values in effect
     LIBRARY_API int setRxSampleRate( int device_id , int sample_rate);
     LIBRARY_API int getActualRxSampleRate( int device_id );
+    // buffering chosen for the current rate, see the "stream" settings of initLibrary
+    LIBRARY_API int getStreamGeometry( int device_id, unsigned int *push_samples, unsigned int *buffer_size,
+                                       unsigned int *num_buffers, unsigned int *num_transfers );
 
+    // counters for capacity planning, reading them does not disturb the stream
+    LIBRARY_API int getStreamStats( int device_id, struct t_stream_stats *stats );
     LIBRARY_API int setRxCenterFreq( int device_id , int64_t freq_hz );
+    // scan mode : retunes on the FPGA timeline, one block of dwell_samples pushed per frequency,
+    // settle_us dropped after each hop. Sync engine only
+    LIBRARY_API int startSweep( int device_id, const int64_t *frequencies, int count,
+                                unsigned int dwell_samples, unsigned int settle_us );
+    LIBRARY_API int stopSweep( int device_id );
     LIBRARY_API int64_t getRxCenterFreq( int device_id );
 
     LIBRARY_API int setRxGain( int device_id, int stage_id, float gain_value );
     LIBRARY_API float getRxGainValue( int device_id , int stage_id );
     LIBRARY_API bool setAutoGainMode( int device_id );
+
+    // sample blocks kept by the host (push callback returned > 0) are given back here
+    LIBRARY_API int releaseSamples( int device_id, float *samples );
 }
 
 #endif // ENTRYPOINT_H
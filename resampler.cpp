@@ -0,0 +1,159 @@
+/* =====================================================================================
+ * Adds BladeRF capability to SDRNode
+ * Copyright (C) 2016 Sylvain AZARIAN <sylvain.azarian@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "resampler.h"
+
+// ~70 dB stop band with a transition of +/-10% of the output rate around its Nyquist frequency
+#define KAISER_BETA (6.76)
+#define TAPS_PER_DECIMATION (22)
+
+// modified Bessel function of the first kind, order 0
+static double bessel_i0( double x ) {
+    double sum = 1.0 ;
+    double term = 1.0 ;
+    for( int k=1 ; k < 50 ; k++ ) {
+        term *= (x / (2.0*k)) * (x / (2.0*k)) ;
+        sum += term ;
+        if( term < sum * 1e-12 )
+            break ;
+    }
+    return( sum );
+}
+
+/**
+ * @brief design_prototype Kaiser windowed sinc at the interp * input rate, cut at the output
+ *        Nyquist frequency, unity gain through each phase
+ */
+static void design_prototype( double *h, unsigned int len, unsigned int interp, unsigned int decim ) {
+    double fc = 0.5 / decim ; // cycles per sample at the interpolated rate
+    double center = (len - 1) / 2.0 ;
+    double i0_beta = bessel_i0( KAISER_BETA );
+    double sum = 0 ;
+
+    for( unsigned int n=0 ; n < len ; n++ ) {
+        double t = n - center ;
+        double sinc = t == 0 ? 2*fc : sin( 2*M_PI*fc*t ) / (M_PI*t) ;
+        double r = t / center ;
+        double w = bessel_i0( KAISER_BETA * sqrt( fmax( 0.0, 1.0 - r*r ))) / i0_beta ;
+        h[n] = sinc * w ;
+        sum += h[n] ;
+    }
+    for( unsigned int n=0 ; n < len ; n++ ) {
+        h[n] *= interp / sum ;
+    }
+}
+
+/**
+ * @brief resampler_create
+ * @param interp
+ * @param decim
+ * @param max_in largest input block
+ * @return NULL if the ratio is not a decimation or on allocation failure
+ */
+struct t_resampler *resampler_create( unsigned int interp, unsigned int decim, unsigned int max_in ) {
+    struct t_resampler *r ;
+
+    if( interp == 0 || decim <= interp || max_in == 0 )
+        return(NULL);
+
+    r = (struct t_resampler *)malloc( sizeof(struct t_resampler));
+    if( r == NULL )
+        return(NULL);
+    memset( r, 0, sizeof(struct t_resampler));
+    r->interp = interp ;
+    r->decim = decim ;
+    r->max_in = max_in ;
+
+    unsigned int taps = (TAPS_PER_DECIMATION * decim + interp - 1) / interp ;
+    taps = (taps + DSP_FIR_TAP_ALIGN - 1) / DSP_FIR_TAP_ALIGN * DSP_FIR_TAP_ALIGN ;
+    r->taps = taps ;
+
+    unsigned int len = interp * taps ;
+    double *h = (double *)malloc( len * sizeof(double));
+    r->coeffs = (float *)malloc( len * sizeof(float));
+    r->hist_i = (float *)malloc( (taps - 1 + max_in) * sizeof(float));
+    r->hist_q = (float *)malloc( (taps - 1 + max_in) * sizeof(float));
+    if( h == NULL || r->coeffs == NULL || r->hist_i == NULL || r->hist_q == NULL ) {
+        free( h );
+        resampler_destroy( r );
+        return(NULL);
+    }
+
+    // phase p holds h[p], h[p + interp], h[p + 2*interp] ... reversed, so that it lines up with
+    // the history where the most recent sample comes last
+    design_prototype( h, len, interp, decim );
+    for( unsigned int p=0 ; p < interp ; p++ ) {
+        for( unsigned int j=0 ; j < taps ; j++ ) {
+            r->coeffs[ p*taps + (taps - 1 - j) ] = (float)h[ p + j*interp ] ;
+        }
+    }
+    free( h );
+    resampler_reset( r );
+    return( r );
+}
+
+void resampler_destroy( struct t_resampler *r ) {
+    if( r == NULL )
+        return ;
+    free( r->coeffs );
+    free( r->hist_i );
+    free( r->hist_q );
+    free( r );
+}
+
+void resampler_reset( struct t_resampler *r ) {
+    memset( r->hist_i, 0, (r->taps - 1) * sizeof(float));
+    memset( r->hist_q, 0, (r->taps - 1) * sizeof(float));
+    r->pos = 0 ;
+}
+
+int resampler_process( struct t_resampler *r, const TYPECPX *in, int count, TYPECPX *out ) {
+    const unsigned int history = r->taps - 1 ;
+    int produced = 0 ;
+
+    if( count <= 0 )
+        return(0);
+    if( (unsigned int)count > r->max_in ) {
+        count = r->max_in ;
+    }
+    const uint64_t end = (uint64_t)count * r->interp ;
+
+    for( int i=0 ; i < count ; i++ ) {
+        r->hist_i[ history + i ] = in[i].re ;
+        r->hist_q[ history + i ] = in[i].im ;
+    }
+
+    // output at interpolated time pos uses input k = pos / interp (last sample of the window)
+    // and phase pos % interp
+    while( r->pos < end ) {
+        unsigned int k = (unsigned int)(r->pos / r->interp) ;
+        unsigned int p = (unsigned int)(r->pos % r->interp) ;
+        (*dsp_fir_dot)( r->coeffs + p * r->taps, r->hist_i + k, r->hist_q + k, r->taps, out + produced );
+        produced++ ;
+        r->pos += r->decim ;
+    }
+    r->pos -= end ;
+
+    memmove( r->hist_i, r->hist_i + count, history * sizeof(float));
+    memmove( r->hist_q, r->hist_q + count, history * sizeof(float));
+    return( produced );
+}
@@ -0,0 +1,52 @@
+/* =====================================================================================
+ * Adds BladeRF capability to SDRNode
+ * Copyright (C) 2016 Sylvain AZARIAN <sylvain.azarian@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <stdint.h>
+#include "dsp_kernels.h"
+
+/*
+ * Polyphase FIR resampler by interp/decim, interp <= decim (decimation only).
+ * The prototype low pass is a Kaiser windowed sinc cut at the output Nyquist frequency,
+ * split in interp phases so only the outputs actually kept are computed.
+ * Input samples are de-interleaved into I and Q histories so each output is two contiguous
+ * dot products done by dsp_fir_dot. The output may overwrite the input.
+ */
+
+struct t_resampler {
+    unsigned int interp ;
+    unsigned int decim ;
+    unsigned int taps ;     // per phase, multiple of DSP_FIR_TAP_ALIGN
+    float *coeffs ;         // interp phases of taps coefficients, time reversed
+    float *hist_i ;         // taps-1 past samples followed by the current block
+    float *hist_q ;
+    unsigned int max_in ;   // largest block accepted by resampler_process
+    uint64_t pos ;          // next output, in interp units from the start of the next block
+};
+
+struct t_resampler *resampler_create( unsigned int interp, unsigned int decim, unsigned int max_in );
+void resampler_destroy( struct t_resampler *r );
+
+// clears the history, for a restart or a retune
+void resampler_reset( struct t_resampler *r );
+
+// filters count samples (count <= max_in), returns the number of samples written to out
+int resampler_process( struct t_resampler *r, const TYPECPX *in, int count, TYPECPX *out );
+
+#endif // RESAMPLER_H
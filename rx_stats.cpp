@@ -0,0 +1,123 @@
+/* =====================================================================================
+ * Adds BladeRF capability to SDRNode
+ * Copyright (C) 2016 Sylvain AZARIAN <sylvain.azarian@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string.h>
+
+#include "rx_stats.h"
+
+// single writer : a plain read followed by an atomic store is enough
+static inline void counter_add( uint64_t *counter, uint64_t n ) {
+    __atomic_store_n( counter, *counter + n, __ATOMIC_RELAXED );
+}
+
+static inline uint64_t counter_get( const uint64_t *counter ) {
+    return( __atomic_load_n( counter, __ATOMIC_RELAXED ));
+}
+
+// 0..3 map to themselves, then 4 buckets per power of two
+static unsigned int bucket_of( uint64_t us ) {
+    if( us < 4 )
+        return( (unsigned int)us );
+    unsigned int msb = 63 - __builtin_clzll( us );
+    unsigned int b = 4*(msb - 1) + (unsigned int)((us >> (msb - 2)) & 3) ;
+    return( b < RX_STATS_LATENCY_BUCKETS ? b : RX_STATS_LATENCY_BUCKETS - 1 );
+}
+
+// smallest value falling in bucket b
+static uint64_t bucket_floor( unsigned int b ) {
+    if( b < 4 )
+        return( b );
+    unsigned int msb = b/4 + 1 ;
+    return( (uint64_t)(4 + b%4) << (msb - 2) );
+}
+
+void rx_stats_reset( struct t_rx_stats *s ) {
+    memset( s, 0, sizeof(struct t_rx_stats));
+}
+
+/**
+ * @brief rx_stats_received accounts a received block and checks it follows the previous one
+ * @param s
+ * @param timestamp of the first sample, 0 if the block has no timestamp
+ * @param count
+ */
+void rx_stats_received( struct t_rx_stats *s, uint64_t timestamp, unsigned int count ) {
+    counter_add( &s->samples_received, count );
+    if( timestamp == 0 ) {
+        __atomic_store_n( &s->next_timestamp, 0, __ATOMIC_RELAXED );
+        return ;
+    }
+    if( s->next_timestamp != 0 && timestamp != s->next_timestamp ) {
+        counter_add( &s->overruns, 1 );
+        if( timestamp > s->next_timestamp ) {
+            counter_add( &s->samples_lost, timestamp - s->next_timestamp );
+        }
+    }
+    __atomic_store_n( &s->next_timestamp, timestamp + count, __ATOMIC_RELAXED );
+}
+
+void rx_stats_short( struct t_rx_stats *s ) {
+    counter_add( &s->short_transfers, 1 );
+}
+
+void rx_stats_restart( struct t_rx_stats *s ) {
+    __atomic_store_n( &s->next_timestamp, 0, __ATOMIC_RELAXED );
+}
+
+void rx_stats_pushed( struct t_rx_stats *s, unsigned int samples, uint64_t latency_ns ) {
+    uint64_t us = latency_ns / 1000 ;
+    counter_add( &s->samples_pushed, samples );
+    counter_add( &s->blocks_pushed, 1 );
+    counter_add( &s->latency_us[bucket_of( us )], 1 );
+    if( us > s->latency_max_us ) {
+        __atomic_store_n( &s->latency_max_us, us, __ATOMIC_RELAXED );
+    }
+}
+
+/**
+ * @brief rx_stats_latency_percentile reads a percentile from the latency histogram
+ * @param s
+ * @param percent 0..100
+ * @return upper bound of the bucket holding the percentile (at most the maximum seen), in microseconds,
+ *         0 without data
+ */
+unsigned int rx_stats_latency_percentile( const struct t_rx_stats *s, double percent ) {
+    uint64_t counts[RX_STATS_LATENCY_BUCKETS] ;
+    uint64_t total = 0 ;
+
+    for( unsigned int b=0 ; b < RX_STATS_LATENCY_BUCKETS ; b++ ) {
+        counts[b] = counter_get( &s->latency_us[b] );
+        total += counts[b] ;
+    }
+    if( total == 0 )
+        return(0);
+
+    uint64_t rank = (uint64_t)(percent / 100.0 * total + 0.5) ;
+    if( rank < 1 ) rank = 1 ;
+    if( rank > total ) rank = total ;
+
+    uint64_t max_us = counter_get( &s->latency_max_us );
+    uint64_t seen = 0 ;
+    for( unsigned int b=0 ; b < RX_STATS_LATENCY_BUCKETS - 1 ; b++ ) {
+        seen += counts[b] ;
+        if( seen >= rank ) {
+            uint64_t bound = bucket_floor( b + 1 ) - 1 ;
+            return( (unsigned int)(bound < max_us ? bound : max_us) );
+        }
+    }
+    return( (unsigned int)max_us );
+}
@@ -0,0 +1,63 @@
+/* =====================================================================================
+ * Adds BladeRF capability to SDRNode
+ * Copyright (C) 2016 Sylvain AZARIAN <sylvain.azarian@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef RX_STATS_H
+#define RX_STATS_H
+
+#include <stdint.h>
+
+/*
+ * Streaming counters of one device.
+ * Each counter has a single writer : the receive side (acquisition thread or stream callback)
+ * or the push side (acquisition or DSP thread). Writers use relaxed atomic stores and readers
+ * relaxed atomic loads, so reading never takes a lock or stalls the stream.
+ * Callback latencies go to a histogram with 4 buckets per power of two microseconds,
+ * percentiles are read from it with a resolution of about 25%.
+ */
+
+#define RX_STATS_LATENCY_BUCKETS (96)
+
+struct t_rx_stats {
+    // receive side
+    uint64_t samples_received ;
+    uint64_t overruns ;         // discontinuities in the sample timestamps
+    uint64_t samples_lost ;     // samples missing between two discontinuous blocks
+    uint64_t short_transfers ;  // reads or USB transfers returning less than asked
+    uint64_t next_timestamp ;   // expected timestamp of the next block, 0 : unknown
+
+    // push side
+    uint64_t samples_pushed ;
+    uint64_t blocks_pushed ;
+    uint64_t latency_max_us ;
+    uint64_t latency_us[RX_STATS_LATENCY_BUCKETS] ;
+};
+
+void rx_stats_reset( struct t_rx_stats *s );
+
+// receive side : a block of count samples starting at timestamp, 0 if unknown
+void rx_stats_received( struct t_rx_stats *s, uint64_t timestamp, unsigned int count );
+void rx_stats_short( struct t_rx_stats *s );
+// the next block does not follow the previous one (stream restart, retune...)
+void rx_stats_restart( struct t_rx_stats *s );
+
+// push side : samples given to the callback and the time it took
+void rx_stats_pushed( struct t_rx_stats *s, unsigned int samples, uint64_t latency_ns );
+
+// callback latency below which percent % of the calls completed, in microseconds
+unsigned int rx_stats_latency_percentile( const struct t_rx_stats *s, double percent );
+
+#endif // RX_STATS_H
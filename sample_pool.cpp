@@ -0,0 +1,227 @@
+/* =====================================================================================
+ * Adds BladeRF capability to SDRNode
+ * Copyright (C) 2016 Sylvain AZARIAN <sylvain.azarian@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sample_pool.h"
+
+static float *alloc_block( struct t_sample_pool *pool ) {
+    return( (float *)malloc( pool->block_samples * 2 * sizeof(float)) );
+}
+
+static inline void stat_add( uint64_t *counter ) {
+    __atomic_fetch_add( counter, 1, __ATOMIC_RELAXED );
+}
+
+/**
+ * @brief sample_pool_create preallocates block_count blocks of block_samples complex samples
+ * @param block_count
+ * @param block_samples
+ * @param host_release true if the host returns the blocks it keeps with releaseSamples()
+ * @return the pool, NULL on allocation failure
+ */
+struct t_sample_pool *sample_pool_create( unsigned int block_count, unsigned int block_samples, bool host_release ) {
+    struct t_sample_pool *pool ;
+
+    if( block_count == 0 || block_samples == 0 )
+        return(NULL);
+
+    pool = (struct t_sample_pool *)malloc( sizeof(struct t_sample_pool));
+    if( pool == NULL )
+        return(NULL);
+
+    memset( pool, 0, sizeof(struct t_sample_pool));
+    pool->block_count = block_count ;
+    pool->block_samples = block_samples ;
+    pool->host_release = host_release ;
+
+    pool->blocks = (float **)malloc( block_count * sizeof(float *));
+    pool->state = (volatile int *)malloc( block_count * sizeof(int));
+    if( host_release ) {
+        pool->overflow = (float **)calloc( block_count, sizeof(float *));
+    }
+    if( pool->blocks == NULL || pool->state == NULL || (host_release && pool->overflow == NULL)) {
+        free( pool->blocks );
+        free( (void *)pool->state );
+        free( pool->overflow );
+        free( pool );
+        return(NULL);
+    }
+
+    for( unsigned int i=0 ; i < block_count ; i++ ) {
+        pool->blocks[i] = alloc_block( pool );
+        pool->state[i] = pool->blocks[i] != NULL ? SAMPLE_BLOCK_FREE : SAMPLE_BLOCK_GONE ;
+    }
+    return( pool );
+}
+
+/**
+ * @brief sample_pool_destroy frees the blocks still owned by the pool. Blocks currently held
+ *        by the host (pool or overflow) are leaked on purpose, as the host may still read them
+ * @param pool
+ */
+void sample_pool_destroy( struct t_sample_pool *pool ) {
+    if( pool == NULL )
+        return ;
+
+    for( unsigned int i=0 ; i < pool->block_count ; i++ ) {
+        if( pool->state[i] == SAMPLE_BLOCK_FREE ) {
+            free( pool->blocks[i] );
+        }
+    }
+    free( pool->blocks );
+    free( (void *)pool->state );
+    free( pool->overflow );
+    free( pool );
+}
+
+static int block_index( struct t_sample_pool *pool, float *block ) {
+    for( unsigned int i=0 ; i < pool->block_count ; i++ ) {
+        if( __atomic_load_n( &pool->blocks[i], __ATOMIC_ACQUIRE ) == block ) {
+            return( (int)i );
+        }
+    }
+    return(-1);
+}
+
+/**
+ * @brief sample_pool_acquire returns a free block. May be called from several threads at once.
+ *        When the pool is exhausted, a block is allocated outside of the pool so no samples are lost
+ * @param pool
+ * @return a block of pool->block_samples complex samples, NULL if out of memory
+ */
+float *sample_pool_acquire( struct t_sample_pool *pool ) {
+    unsigned int n = pool->block_count ;
+
+    for( unsigned int k=0 ; k < n ; k++ ) {
+        unsigned int i = __atomic_fetch_add( &pool->cursor, 1, __ATOMIC_RELAXED ) % n ;
+
+        if( __sync_bool_compare_and_swap( &pool->state[i], SAMPLE_BLOCK_GONE, SAMPLE_BLOCK_ALLOCATING )) {
+            // previous block for this slot was handed to a legacy host, we are the only one replacing it
+            float *block = alloc_block( pool );
+            if( block == NULL ) {
+                __atomic_store_n( &pool->state[i], SAMPLE_BLOCK_GONE, __ATOMIC_RELEASE );
+                continue ;
+            }
+            __atomic_store_n( &pool->blocks[i], block, __ATOMIC_RELEASE );
+            __atomic_store_n( &pool->state[i], SAMPLE_BLOCK_IN_USE, __ATOMIC_RELEASE );
+            stat_add( &pool->stats.fallback_allocs );
+            stat_add( &pool->stats.acquired );
+            return( block );
+        }
+        if( __sync_bool_compare_and_swap( &pool->state[i], SAMPLE_BLOCK_FREE, SAMPLE_BLOCK_IN_USE )) {
+            stat_add( &pool->stats.acquired );
+            return( __atomic_load_n( &pool->blocks[i], __ATOMIC_ACQUIRE ));
+        }
+    }
+
+    stat_add( &pool->stats.exhausted );
+    stat_add( &pool->stats.fallback_allocs );
+    return( alloc_block( pool ) );
+}
+
+/**
+ * @brief sample_pool_lend marks a block about to be pushed as held by the host, host_release only.
+ *        Done before the push so that a releaseSamples() racing with the callback finds it
+ * @param pool
+ * @param block
+ */
+void sample_pool_lend( struct t_sample_pool *pool, float *block ) {
+    if( !pool->host_release )
+        return ;
+
+    int i = block_index( pool, block );
+    if( i >= 0 ) {
+        __atomic_store_n( &pool->state[i], SAMPLE_BLOCK_HELD, __ATOMIC_RELEASE );
+        return ;
+    }
+    for( unsigned int k=0 ; k < pool->block_count ; k++ ) {
+        if( __sync_bool_compare_and_swap( &pool->overflow[k], (float *)NULL, block )) {
+            return ;
+        }
+    }
+    stat_add( &pool->stats.untracked ); // cannot be released, leaked rather than freed blindly
+}
+
+/**
+ * @brief sample_pool_recycle gives back a block the callback did not keep
+ * @param pool
+ * @param block
+ */
+void sample_pool_recycle( struct t_sample_pool *pool, float *block ) {
+    int i = block_index( pool, block );
+    if( i < 0 ) {
+        // allocated while the pool was exhausted, forgotten by the overflow set if it was lent
+        for( unsigned int k=0 ; pool->host_release && k < pool->block_count ; k++ ) {
+            if( __sync_bool_compare_and_swap( &pool->overflow[k], block, (float *)NULL ))
+                break ;
+        }
+        free( block );
+        return ;
+    }
+    stat_add( &pool->stats.recycled );
+    __sync_lock_release( &pool->state[i] );
+}
+
+/**
+ * @brief sample_pool_handoff records that the callback kept the block
+ * @param pool
+ * @param block
+ */
+void sample_pool_handoff( struct t_sample_pool *pool, float *block ) {
+    if( pool->host_release )
+        return ; // lent before the push, will come back through sample_pool_release()
+
+    int i = block_index( pool, block );
+    stat_add( &pool->stats.handed_off );
+    if( i >= 0 ) {
+        // forget the pointer first : once freed by the host, its address may come back from malloc()
+        __atomic_store_n( &pool->blocks[i], (float *)NULL, __ATOMIC_RELEASE );
+        __atomic_store_n( &pool->state[i], SAMPLE_BLOCK_GONE, __ATOMIC_RELEASE );
+    }
+}
+
+/**
+ * @brief sample_pool_release gives back a block kept by the host. May be called from any thread.
+ *        Only a block the host holds is taken : a pool block goes back to the pool, an overflow
+ *        block is freed
+ * @param pool
+ * @param block
+ * @return 0 if the block was taken back, -1 if the host did not hold it
+ */
+int sample_pool_release( struct t_sample_pool *pool, float *block ) {
+    int i = block_index( pool, block );
+    if( i >= 0 ) {
+        if( !__sync_bool_compare_and_swap( &pool->state[i], SAMPLE_BLOCK_HELD, SAMPLE_BLOCK_FREE )) {
+            stat_add( &pool->stats.rejected );
+            return(-1);
+        }
+        stat_add( &pool->stats.released );
+        return(0);
+    }
+    for( unsigned int k=0 ; k < pool->block_count ; k++ ) {
+        if( __sync_bool_compare_and_swap( &pool->overflow[k], block, (float *)NULL )) {
+            stat_add( &pool->stats.released );
+            free( block );
+            return(0);
+        }
+    }
+    stat_add( &pool->stats.rejected );
+    return(-1);
+}
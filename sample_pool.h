@@ -0,0 +1,86 @@
+/* =====================================================================================
+ * Adds BladeRF capability to SDRNode
+ * Copyright (C) 2016 Sylvain AZARIAN <sylvain.azarian@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SAMPLE_POOL_H
+#define SAMPLE_POOL_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+/*
+ * Fixed-size pool of IQ sample blocks handed to the SDRNode push callback.
+ *
+ * Ownership protocol :
+ *  - a thread producing samples (acquisition, DSP or stream callback) takes a block with
+ *    sample_pool_acquire() and fills it. Several threads may acquire at the same time
+ *  - the push callback returns <= 0 : the driver still owns the block and gives it
+ *    back with sample_pool_recycle()
+ *  - the push callback returns > 0 : SDRNode owns the block.
+ *      + if the host announced it returns blocks (host_release), it calls releaseSamples()
+ *        when done and the block goes back to the pool. The block is lent (HELD) before the
+ *        push, as the host may release it from another thread before the callback returns.
+ *        A block allocated outside the pool is remembered in the overflow set until released,
+ *        then freed. Releasing a block the host does not hold (twice, or never kept) is refused
+ *      + otherwise (legacy hosts) SDRNode will free() it, so the slot is
+ *        forgotten and a new block is allocated the next time it is needed
+ *
+ * Every block is a separate malloc() so that legacy hosts can still free() them.
+ * Slot states change with atomic operations only, a GONE slot is claimed (ALLOCATING) by the
+ * one thread that reallocates it. Counters are updated with atomic adds.
+ */
+
+#define SAMPLE_POOL_DEFAULT_BLOCKS (32)
+
+#define SAMPLE_BLOCK_FREE    (0)
+#define SAMPLE_BLOCK_IN_USE  (1)
+#define SAMPLE_BLOCK_GONE    (2)  // handed to a legacy host, must be reallocated
+#define SAMPLE_BLOCK_ALLOCATING (3) // GONE slot being reallocated by an acquiring thread
+#define SAMPLE_BLOCK_HELD    (4)  // kept by a host_release host, until sample_pool_release()
+
+struct t_pool_stats {
+    uint64_t acquired ;     // blocks given to the producing threads
+    uint64_t recycled ;     // blocks returned by the driver (callback <= 0)
+    uint64_t released ;     // blocks returned by the host (releaseSamples)
+    uint64_t handed_off ;   // blocks kept and freed by a legacy host
+    uint64_t exhausted ;    // acquire found no free block
+    uint64_t fallback_allocs ; // blocks malloc'ed outside the pool (exhaustion or handoff)
+    uint64_t rejected ;     // releases of blocks the host did not hold
+    uint64_t untracked ;    // overflow blocks lent while the overflow set was full, leaked if kept
+};
+
+struct t_sample_pool {
+    float **blocks ;
+    volatile int *state ;
+    unsigned int block_count ;
+    unsigned int block_samples ; // capacity of one block, in complex samples
+    volatile unsigned int cursor ; // next slot to probe, shared by the acquiring threads
+    bool host_release ;          // host hands blocks back with releaseSamples()
+    float **overflow ;           // host_release : overflow blocks held by the host, NULL entries are free
+
+    struct t_pool_stats stats ;
+};
+
+struct t_sample_pool *sample_pool_create( unsigned int block_count, unsigned int block_samples, bool host_release );
+void sample_pool_destroy( struct t_sample_pool *pool );
+
+float *sample_pool_acquire( struct t_sample_pool *pool );
+void sample_pool_lend( struct t_sample_pool *pool, float *block );
+void sample_pool_recycle( struct t_sample_pool *pool, float *block );
+void sample_pool_handoff( struct t_sample_pool *pool, float *block );
+int sample_pool_release( struct t_sample_pool *pool, float *block );
+
+#endif // SAMPLE_POOL_H
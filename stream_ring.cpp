@@ -0,0 +1,161 @@
+/* =====================================================================================
+ * Adds BladeRF capability to SDRNode
+ * Copyright (C) 2016 Sylvain AZARIAN <sylvain.azarian@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+
+#include "stream_ring.h"
+
+/**
+ * @brief stream_ring_create allocates a ring of depth slots of slot_samples IQ samples
+ * @param depth
+ * @param slot_samples
+ * @return the ring, NULL on allocation failure
+ */
+struct t_stream_ring *stream_ring_create( unsigned int depth, unsigned int slot_samples ) {
+    struct t_stream_ring *ring ;
+
+    if( depth < 2 || slot_samples == 0 )
+        return(NULL);
+
+    ring = (struct t_stream_ring *)malloc( sizeof(struct t_stream_ring));
+    if( ring == NULL )
+        return(NULL);
+    memset( ring, 0, sizeof(struct t_stream_ring));
+
+    ring->slots = (struct t_ring_slot *)malloc( depth * sizeof(struct t_ring_slot));
+    if( ring->slots == NULL ) {
+        free( ring );
+        return(NULL);
+    }
+    ring->depth = depth ;
+    ring->slot_samples = slot_samples ;
+    for( unsigned int i=0 ; i < depth ; i++ ) {
+        ring->slots[i].iq = (int16_t *)malloc( slot_samples * 2 * sizeof(int16_t));
+        ring->slots[i].count = 0 ;
+        ring->slots[i].timestamp = 0 ;
+        if( ring->slots[i].iq == NULL ) {
+            ring->depth = i ;
+            stream_ring_destroy( ring );
+            return(NULL);
+        }
+    }
+    sem_init( &ring->filled, 0, 0 );
+    return( ring );
+}
+
+void stream_ring_destroy( struct t_stream_ring *ring ) {
+    if( ring == NULL )
+        return ;
+    for( unsigned int i=0 ; i < ring->depth ; i++ ) {
+        free( ring->slots[i].iq );
+    }
+    sem_destroy( &ring->filled );
+    free( ring->slots );
+    free( ring );
+}
+
+/**
+ * @brief stream_ring_write_slot returns the slot the producer can fill, NULL if the ring is full
+ * @param ring
+ * @return
+ */
+struct t_ring_slot *stream_ring_write_slot( struct t_stream_ring *ring ) {
+    unsigned int head = ring->head ;
+    unsigned int tail = __atomic_load_n( &ring->tail, __ATOMIC_ACQUIRE );
+
+    if( head - tail >= ring->depth ) {
+        return(NULL);
+    }
+    return( &ring->slots[ head % ring->depth ] );
+}
+
+/**
+ * @brief stream_ring_commit publishes the slot returned by stream_ring_write_slot() to the consumer
+ * @param ring
+ */
+void stream_ring_commit( struct t_stream_ring *ring ) {
+    unsigned int head = ring->head + 1 ;
+    unsigned int used = head - __atomic_load_n( &ring->tail, __ATOMIC_ACQUIRE );
+
+    if( used > ring->stats.high_water ) {
+        ring->stats.high_water = used ;
+    }
+    ring->stats.committed++ ;
+    __atomic_store_n( &ring->head, head, __ATOMIC_RELEASE );
+    sem_post( &ring->filled );
+}
+
+/**
+ * @brief stream_ring_drop records samples lost because the ring was full
+ * @param ring
+ * @param samples
+ */
+void stream_ring_drop( struct t_stream_ring *ring, unsigned int samples ) {
+    ring->stats.overruns++ ;
+    ring->stats.dropped_samples += samples ;
+}
+
+/**
+ * @brief stream_ring_drained true once the consumer released every committed slot
+ * @param ring
+ * @return
+ */
+bool stream_ring_drained( struct t_stream_ring *ring ) {
+    return( __atomic_load_n( &ring->tail, __ATOMIC_ACQUIRE ) == ring->head );
+}
+
+/**
+ * @brief stream_ring_read_slot waits for the next filled slot
+ * @param ring
+ * @param timeout_ms
+ * @return the slot, NULL on timeout
+ */
+struct t_ring_slot *stream_ring_read_slot( struct t_stream_ring *ring, unsigned int timeout_ms ) {
+    struct timespec ts ;
+
+    clock_gettime( CLOCK_REALTIME, &ts );
+    ts.tv_sec += timeout_ms / 1000 ;
+    ts.tv_nsec += (timeout_ms % 1000) * 1000000L ;
+    if( ts.tv_nsec >= 1000000000L ) {
+        ts.tv_sec++ ;
+        ts.tv_nsec -= 1000000000L ;
+    }
+    while( sem_timedwait( &ring->filled, &ts ) != 0 ) {
+        if( errno != EINTR ) {
+            return(NULL);
+        }
+    }
+
+    unsigned int tail = ring->tail ;
+    if( __atomic_load_n( &ring->head, __ATOMIC_ACQUIRE ) == tail ) {
+        return(NULL);
+    }
+    return( &ring->slots[ tail % ring->depth ] );
+}
+
+/**
+ * @brief stream_ring_release gives the slot returned by stream_ring_read_slot() back to the producer
+ * @param ring
+ */
+void stream_ring_release( struct t_stream_ring *ring ) {
+    ring->stats.consumed++ ;
+    __atomic_store_n( &ring->tail, ring->tail + 1, __ATOMIC_RELEASE );
+}
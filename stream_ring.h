@@ -0,0 +1,71 @@
+/* =====================================================================================
+ * Adds BladeRF capability to SDRNode
+ * Copyright (C) 2016 Sylvain AZARIAN <sylvain.azarian@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef STREAM_RING_H
+#define STREAM_RING_H
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <semaphore.h>
+
+/*
+ * Single producer / single consumer ring of raw SC16Q11 blocks, between the receive thread
+ * (producer) and the DSP/push thread (consumer).
+ * Indexes are free running counters, the producer only writes head, the consumer only writes tail.
+ * The consumer sleeps on a semaphore posted once per committed slot.
+ */
+
+struct t_ring_slot {
+    int16_t *iq ;           // interleaved I/Q
+    unsigned int count ;    // number of IQ samples in the slot
+    uint64_t timestamp ;    // timestamp of the first sample
+};
+
+struct t_ring_stats {
+    uint64_t committed ;    // slots written by the producer
+    uint64_t consumed ;     // slots released by the consumer
+    uint64_t overruns ;     // slots dropped because the ring was full
+    uint64_t dropped_samples ;
+    unsigned int high_water ; // maximum number of slots waiting
+};
+
+struct t_stream_ring {
+    struct t_ring_slot *slots ;
+    unsigned int depth ;
+    unsigned int slot_samples ; // capacity of one slot, in IQ samples
+
+    volatile unsigned int head ; // next slot to write
+    volatile unsigned int tail ; // next slot to read
+    sem_t filled ;
+
+    struct t_ring_stats stats ;
+};
+
+struct t_stream_ring *stream_ring_create( unsigned int depth, unsigned int slot_samples );
+void stream_ring_destroy( struct t_stream_ring *ring );
+
+// producer side
+struct t_ring_slot *stream_ring_write_slot( struct t_stream_ring *ring );
+void stream_ring_commit( struct t_stream_ring *ring );
+void stream_ring_drop( struct t_stream_ring *ring, unsigned int samples );
+bool stream_ring_drained( struct t_stream_ring *ring );
+
+// consumer side
+struct t_ring_slot *stream_ring_read_slot( struct t_stream_ring *ring, unsigned int timeout_ms );
+void stream_ring_release( struct t_stream_ring *ring );
+
+#endif // STREAM_RING_H
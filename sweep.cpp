@@ -0,0 +1,102 @@
+/* =====================================================================================
+ * Adds BladeRF capability to SDRNode
+ * Copyright (C) 2016 Sylvain AZARIAN <sylvain.azarian@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "sweep.h"
+
+struct t_sweep *sweep_create( const struct t_sweep_plan *plan ) {
+    struct t_sweep *s = (struct t_sweep *)malloc( sizeof(struct t_sweep));
+    if( s == NULL )
+        return( NULL );
+    memset( s, 0, sizeof(struct t_sweep));
+    s->plan = *plan ;
+    s->plan.frequency = (int64_t *)malloc( plan->count * sizeof(int64_t));
+    if( s->plan.frequency == NULL ) {
+        free( s );
+        return( NULL );
+    }
+    memcpy( s->plan.frequency, plan->frequency, plan->count * sizeof(int64_t));
+    return( s );
+}
+
+void sweep_free( struct t_sweep *s ) {
+    if( s == NULL )
+        return ;
+    free( s->plan.frequency );
+    free( s );
+}
+
+void sweep_restart( struct t_sweep *s ) {
+    s->next_hop = 0 ;
+    s->first = 0 ;
+    s->queued = 0 ;
+}
+
+/**
+ * @brief sweep_start sets the timestamp of the first hop, the scan carries on from the frequency it had reached
+ * @param s
+ * @param origin
+ * @param hw_rate timestamp ticks per second
+ */
+void sweep_start( struct t_sweep *s, uint64_t origin, unsigned int hw_rate ) {
+    s->settle_samples = (unsigned int)((uint64_t)s->plan.settle_us * hw_rate / 1000000) ;
+    s->next_hop = origin ;
+    s->first = 0 ;
+    s->queued = 0 ;
+}
+
+bool sweep_next_hop( struct t_sweep *s, uint64_t not_before, struct t_dwell **dwell ) {
+    if( s->next_hop == 0 || s->queued >= SWEEP_AHEAD )
+        return( false );
+
+    uint64_t period = (uint64_t)s->settle_samples + s->plan.dwell_samples ;
+    while( s->next_hop < not_before ) {
+        s->next_hop += period ;
+        s->next_index = (s->next_index + 1) % s->plan.count ;
+        s->dwells_late++ ;
+    }
+    struct t_dwell *d = &s->dwells[(s->first + s->queued) % SWEEP_AHEAD] ;
+    d->hop = s->next_hop ;
+    d->frequency = s->plan.frequency[s->next_index] ;
+    d->filled = 0 ;
+    s->queued++ ;
+    s->next_hop += period ;
+    s->next_index = (s->next_index + 1) % s->plan.count ;
+    *dwell = d ;
+    return( true );
+}
+
+void sweep_cancel_hop( struct t_sweep *s ) {
+    if( s->queued == 0 )
+        return ;
+    s->queued-- ;
+    s->next_hop -= (uint64_t)s->settle_samples + s->plan.dwell_samples ;
+    s->next_index = (s->next_index + s->plan.count - 1) % s->plan.count ;
+}
+
+struct t_dwell *sweep_front( struct t_sweep *s ) {
+    return( s->queued > 0 ? &s->dwells[s->first] : NULL );
+}
+
+void sweep_pop( struct t_sweep *s ) {
+    if( s->queued == 0 )
+        return ;
+    s->first = (s->first + 1) % SWEEP_AHEAD ;
+    s->queued-- ;
+}
@@ -0,0 +1,86 @@
+/* =====================================================================================
+ * Adds BladeRF capability to SDRNode
+ * Copyright (C) 2016 Sylvain AZARIAN <sylvain.azarian@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <stdint.h>
+
+/*
+ * Scan plan of the sweep mode. Hops follow each other every settle + dwell samples on the hardware
+ * timestamp line, from an origin set when the stream position is known : hop k tunes to
+ * frequency[k % count] at origin + k * period, the samples [hop + settle, hop + settle + dwell[
+ * make the dwell pushed for that frequency. Only SWEEP_AHEAD hops are queued in the FPGA at a
+ * time (its retune queue holds 16), each hop being kept as a pending dwell until the samples
+ * have gone past it.
+ * Used only by the acquisition thread, no locking.
+ */
+
+#define SWEEP_MAX_FREQUENCIES (4096)
+#define SWEEP_AHEAD (8)
+
+struct t_sweep_plan {
+    int count ;
+    int64_t *frequency ;
+    unsigned int dwell_samples ;
+    unsigned int settle_us ;
+};
+
+struct t_dwell {
+    uint64_t hop ;      // timestamp of the retune
+    int64_t frequency ;
+    unsigned int filled ;
+};
+
+struct t_sweep {
+    struct t_sweep_plan plan ;
+    unsigned int settle_samples ; // settle_us at the current hardware rate
+    uint64_t next_hop ;           // timestamp of the next hop to queue, 0 : not started
+    int next_index ;              // in plan.frequency
+
+    struct t_dwell dwells[SWEEP_AHEAD] ; // queued hops, oldest first
+    int first ;
+    int queued ;
+
+    uint64_t dwells_pushed ;
+    uint64_t dwells_late ;       // hop could not be queued before its timestamp, skipped
+    uint64_t dwells_incomplete ; // samples lost during the dwell
+};
+
+// copies the plan, NULL if out of memory
+struct t_sweep *sweep_create( const struct t_sweep_plan *plan );
+void sweep_free( struct t_sweep *s );
+
+// forgets the queued hops, the schedule starts again from the next sweep_start()
+void sweep_restart( struct t_sweep *s );
+void sweep_start( struct t_sweep *s, uint64_t origin, unsigned int hw_rate );
+
+// next hop to queue, at or after not_before. Hops whose turn is before not_before are skipped.
+// false if SWEEP_AHEAD hops are already queued or the schedule is not started
+bool sweep_next_hop( struct t_sweep *s, uint64_t not_before, struct t_dwell **dwell );
+// the hop returned last could not be queued in the FPGA
+void sweep_cancel_hop( struct t_sweep *s );
+
+// oldest queued hop, NULL if none
+struct t_dwell *sweep_front( struct t_sweep *s );
+void sweep_pop( struct t_sweep *s );
+
+static inline uint64_t sweep_dwell_begin( const struct t_sweep *s, const struct t_dwell *d ) {
+    return( d->hop + s->settle_samples );
+}
+
+#endif // SWEEP_H
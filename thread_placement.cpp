@@ -0,0 +1,200 @@
+/* =====================================================================================
+ * Adds BladeRF capability to SDRNode
+ * Copyright (C) 2016 Sylvain AZARIAN <sylvain.azarian@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "thread_placement.h"
+
+static const char *thread_names[PLACEMENT_THREAD_COUNT] = { "acquisition", "sync_worker", "dsp" };
+
+void placement_init( struct t_thread_placement *p ) {
+    memset( p, 0, sizeof(struct t_thread_placement));
+    p->policy = SCHED_OTHER ;
+    p->priority = 0 ;
+    p->numa_node = -1 ;
+}
+
+#ifndef _WINDOWS
+
+static int read_line( const char *path, char *buf, size_t len ) {
+    FILE *f = fopen( path, "r" );
+    if( f == NULL )
+        return(-1);
+    if( fgets( buf, (int)len, f ) == NULL ) {
+        fclose(f);
+        return(-1);
+    }
+    fclose(f);
+    buf[ strcspn( buf, "\r\n" ) ] = 0 ;
+    return(0);
+}
+
+/**
+ * @brief placement_usb_numa_node /sys/bus/usb/devices/usbN links to the root hub, its parent is the
+ *        PCI host controller which exposes numa_node
+ * @param usb_bus
+ * @return the node, -1 if unknown or not a NUMA machine
+ */
+int placement_usb_numa_node( int usb_bus ) {
+    char path[PATH_MAX + 16] ;
+    char real[PATH_MAX] ;
+    char value[32] ;
+
+    snprintf( path, sizeof(path), "/sys/bus/usb/devices/usb%d", usb_bus );
+    if( realpath( path, real ) == NULL )
+        return(-1);
+
+    char *slash = strrchr( real, '/' );
+    if( slash == NULL )
+        return(-1);
+    *slash = 0 ;
+
+    snprintf( path, sizeof(path), "%s/numa_node", real );
+    if( read_line( path, value, sizeof(value)) != 0 )
+        return(-1);
+    return( atoi(value) );
+}
+
+void placement_bind_node( struct t_thread_placement *p ) {
+    char path[64] ;
+    char cpus[PLACEMENT_CPUS_LEN] ;
+
+    if( p->numa_node < 0 )
+        return ;
+    snprintf( path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", p->numa_node );
+    if( read_line( path, cpus, sizeof(cpus)) != 0 )
+        return ;
+
+    for( int k=0 ; k < PLACEMENT_THREAD_COUNT ; k++ ) {
+        if( p->cpus[k][0] == 0 ) {
+            snprintf( p->cpus[k], PLACEMENT_CPUS_LEN, "%s", cpus );
+        }
+    }
+}
+
+// "0-3,8" -> cpu_set_t
+static int parse_cpulist( const char *list, cpu_set_t *set ) {
+    const char *s = list ;
+    CPU_ZERO( set );
+    while( *s ) {
+        char *end ;
+        long first = strtol( s, &end, 10 );
+        long last = first ;
+        if( end == s )
+            return(-1);
+        s = end ;
+        if( *s == '-' ) {
+            s++ ;
+            last = strtol( s, &end, 10 );
+            if( end == s )
+                return(-1);
+            s = end ;
+        }
+        for( long c = first ; c <= last && c < CPU_SETSIZE ; c++ ) {
+            CPU_SET( (int)c, set );
+        }
+        while( *s == ',' || *s == ' ' ) s++ ;
+    }
+    return(0);
+}
+
+int placement_apply_self( const struct t_thread_placement *p, int which, char *report, size_t len ) {
+    int rc = 0 ;
+    const char *cpus = p->cpus[which] ;
+    char affinity[PLACEMENT_CPUS_LEN + 32] = "default" ;
+    char sched[64] = "default" ;
+
+    if( cpus[0] != 0 ) {
+        cpu_set_t set ;
+        if( parse_cpulist( cpus, &set ) == 0 &&
+            pthread_setaffinity_np( pthread_self(), sizeof(set), &set ) == 0 ) {
+            snprintf( affinity, sizeof(affinity), "%s", cpus );
+        } else {
+            snprintf( affinity, sizeof(affinity), "%s (failed)", cpus );
+            rc = -1 ;
+        }
+    }
+
+    if( p->policy != SCHED_OTHER ) {
+        struct sched_param param ;
+        memset( &param, 0, sizeof(param));
+        param.sched_priority = p->priority ;
+        int err = pthread_setschedparam( pthread_self(), p->policy, &param );
+        snprintf( sched, sizeof(sched), "%s/%d%s", p->policy == SCHED_FIFO ? "fifo" : "rr",
+                  p->priority, err == 0 ? "" : " (failed)" );
+        if( err != 0 ) rc = -1 ;
+    }
+
+    snprintf( report, len, "%s thread: cpus=%s sched=%s numa_node=%d",
+              thread_names[which], affinity, sched, p->numa_node );
+    return( rc );
+}
+
+int placement_save_self( struct t_placement_saved *saved ) {
+    saved->valid = 0 ;
+    if( pthread_getaffinity_np( pthread_self(), sizeof(saved->cpus), &saved->cpus ) != 0 )
+        return(-1);
+    if( pthread_getschedparam( pthread_self(), &saved->policy, &saved->param ) != 0 )
+        return(-1);
+    saved->valid = 1 ;
+    return(0);
+}
+
+int placement_restore_self( const struct t_placement_saved *saved ) {
+    int rc = 0 ;
+
+    if( !saved->valid )
+        return(-1);
+    if( pthread_setaffinity_np( pthread_self(), sizeof(saved->cpus), &saved->cpus ) != 0 )
+        rc = -1 ;
+    if( pthread_setschedparam( pthread_self(), saved->policy, &saved->param ) != 0 )
+        rc = -1 ;
+    return( rc );
+}
+
+#else
+
+int placement_usb_numa_node( int usb_bus ) {
+    return(-1);
+}
+
+void placement_bind_node( struct t_thread_placement *p ) {
+}
+
+int placement_apply_self( const struct t_thread_placement *p, int which, char *report, size_t len ) {
+    snprintf( report, len, "%s thread: placement not supported on this platform", thread_names[which] );
+    return(-1);
+}
+
+int placement_save_self( struct t_placement_saved *saved ) {
+    saved->valid = 0 ;
+    return(-1);
+}
+
+int placement_restore_self( const struct t_placement_saved *saved ) {
+    return(-1);
+}
+
+#endif
@@ -0,0 +1,76 @@
+/* =====================================================================================
+ * Adds BladeRF capability to SDRNode
+ * Copyright (C) 2016 Sylvain AZARIAN <sylvain.azarian@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef THREAD_PLACEMENT_H
+#define THREAD_PLACEMENT_H
+
+#include <stddef.h>
+#ifndef _WINDOWS
+#include <sched.h>
+#endif
+
+/*
+ * CPU affinity, scheduling class and NUMA node for the threads of one device.
+ * CPU sets use the Linux cpulist syntax ("2", "0-3,8"), an empty string keeps the default.
+ * The libbladeRF sync worker (which also runs the libusb event loop) is created by
+ * bladerf_sync_config() and inherits the affinity and scheduling of the calling thread, so it
+ * is placed by switching the acquisition thread to the worker settings around that call, then
+ * back to the affinity and scheduling saved before the switch.
+ * NUMA placement relies on the first-touch policy : buffers are touched by threads pinned
+ * to the CPUs of the node the USB controller is attached to.
+ */
+
+#define PLACEMENT_CPUS_LEN (128)
+
+#define PLACEMENT_THREAD_ACQUISITION (0)
+#define PLACEMENT_THREAD_SYNC_WORKER (1)
+#define PLACEMENT_THREAD_DSP         (2)
+#define PLACEMENT_THREAD_COUNT       (3)
+
+// affinity and scheduling of a thread, to undo a temporary placement
+struct t_placement_saved {
+    int valid ;
+#ifndef _WINDOWS
+    cpu_set_t cpus ;
+    int policy ;
+    struct sched_param param ;
+#endif
+};
+
+struct t_thread_placement {
+    char cpus[PLACEMENT_THREAD_COUNT][PLACEMENT_CPUS_LEN] ;
+    int policy ;     // SCHED_OTHER, SCHED_FIFO or SCHED_RR
+    int priority ;   // for SCHED_FIFO / SCHED_RR
+    int numa_node ;  // -1 : no NUMA placement
+};
+
+void placement_init( struct t_thread_placement *p );
+
+// NUMA node of the PCI controller hosting the given USB bus, -1 if unknown
+int placement_usb_numa_node( int usb_bus );
+
+// fills empty CPU sets with the CPUs of p->numa_node
+void placement_bind_node( struct t_thread_placement *p );
+
+// applies the placement of thread 'which' to the calling thread, writes what was done into report
+int placement_apply_self( const struct t_thread_placement *p, int which, char *report, size_t len );
+
+// saves / restores the affinity and scheduling of the calling thread
+int placement_save_self( struct t_placement_saved *saved );
+int placement_restore_self( const struct t_placement_saved *saved );
+
+#endif // THREAD_PLACEMENT_H
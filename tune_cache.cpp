@@ -0,0 +1,71 @@
+/* =====================================================================================
+ * Adds BladeRF capability to SDRNode
+ * Copyright (C) 2016 Sylvain AZARIAN <sylvain.azarian@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string.h>
+
+#include "tune_cache.h"
+
+void tune_cache_init( struct t_tune_cache *c ) {
+    memset( c, 0, sizeof(struct t_tune_cache));
+}
+
+static struct t_tune_entry *lookup( struct t_tune_cache *c, unsigned int frequency ) {
+    for( int i=0 ; i < TUNE_CACHE_ENTRIES ; i++ ) {
+        if( c->entries[i].frequency == frequency ) {
+            return( &c->entries[i] );
+        }
+    }
+    return( NULL );
+}
+
+bool tune_cache_find( struct t_tune_cache *c, unsigned int frequency, struct bladerf_quick_tune *values ) {
+    struct t_tune_entry *e = frequency != 0 ? lookup( c, frequency ) : NULL ;
+    if( e == NULL ) {
+        c->misses++ ;
+        return( false );
+    }
+    e->last_use = ++c->clock ;
+    *values = e->values ;
+    c->hits++ ;
+    return( true );
+}
+
+/**
+ * @brief tune_cache_store adds or refreshes the entry of frequency, replacing a free entry
+ *        or the least recently used one
+ * @param c
+ * @param frequency
+ * @param values read with bladerf_get_quick_tune() right after tuning to frequency
+ */
+void tune_cache_store( struct t_tune_cache *c, unsigned int frequency, const struct bladerf_quick_tune *values ) {
+    if( frequency == 0 )
+        return ;
+
+    struct t_tune_entry *e = lookup( c, frequency );
+    if( e == NULL ) {
+        e = &c->entries[0] ;
+        for( int i=0 ; i < TUNE_CACHE_ENTRIES && e->frequency != 0 ; i++ ) {
+            struct t_tune_entry *candidate = &c->entries[i] ;
+            if( candidate->frequency == 0 || candidate->last_use < e->last_use ) {
+                e = candidate ;
+            }
+        }
+    }
+    e->frequency = frequency ;
+    e->last_use = ++c->clock ;
+    e->values = *values ;
+}
@@ -0,0 +1,53 @@
+/* =====================================================================================
+ * Adds BladeRF capability to SDRNode
+ * Copyright (C) 2016 Sylvain AZARIAN <sylvain.azarian@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef TUNE_CACHE_H
+#define TUNE_CACHE_H
+
+#include "BladeRF/nuand/libbladeRF.h"
+
+/*
+ * LMS6002D "quick tune" register values of the frequencies a device was tuned to, so that going
+ * back to one of them skips the VCO search. Entries are filled after each full tune and the least
+ * recently used one is replaced when the cache is full. The values drift with temperature : a full
+ * tune to the same frequency refreshes its entry.
+ * Used only by the thread applying the control commands, no locking.
+ */
+
+#define TUNE_CACHE_ENTRIES (64)
+
+struct t_tune_entry {
+    unsigned int frequency ; // Hz, 0 : unused
+    unsigned int last_use ;
+    struct bladerf_quick_tune values ;
+};
+
+struct t_tune_cache {
+    struct t_tune_entry entries[TUNE_CACHE_ENTRIES] ;
+    unsigned int clock ;
+    uint64_t hits ;
+    uint64_t misses ;
+};
+
+void tune_cache_init( struct t_tune_cache *c );
+
+// true and values filled if frequency is cached
+bool tune_cache_find( struct t_tune_cache *c, unsigned int frequency, struct bladerf_quick_tune *values );
+
+void tune_cache_store( struct t_tune_cache *c, unsigned int frequency, const struct bladerf_quick_tune *values );
+
+#endif // TUNE_CACHE_H